@@ -37,6 +37,12 @@ public:
 		return SDL_AudioStreamDevicePaused(stream);
 	}
 
+	// Returns false if the device could not be opened, or if it is not consuming audio.
+	bool IsPlaying()
+	{
+		return stream != nullptr && !GetPaused();
+	}
+
 	void SetPaused(const bool paused)
 	{
 		if (paused)
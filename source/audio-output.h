@@ -31,6 +31,12 @@ public:
 
 	void MixerEnd();
 
+	// Throws away the audio for this frame, without disturbing the dynamic rate control.
+	void MixerDiscard()
+	{
+		mixer.End([]([[maybe_unused]] const cc_s16l* const audio_samples, [[maybe_unused]] const std::size_t total_frames) {});
+	}
+
 	cc_s16l* MixerAllocateFMSamples(const std::size_t total_frames)
 	{
 		return mixer.AllocateFMSamples(total_frames);
@@ -52,11 +58,13 @@ public:
 	}
 
 	cc_u32f GetAverageFrames() const;
+	cc_u32f GetQueuedFrames() { return device.GetTotalQueuedFrames(); }
 	cc_u32f GetTargetFrames() const { return std::max<cc_u32f>(total_buffer_frames * 2, sample_rate / 20); } // 50ms
 	cc_u32f GetTotalBufferFrames() const { return total_buffer_frames; }
 	cc_u32f GetSampleRate() const { return sample_rate; }
 
 	bool GetPaused() { return device.GetPaused(); }
+	bool IsPlaying() { return device.IsPlaying(); }
 	void SetPaused(const bool paused) { device.SetPaused(paused); }
 };
 
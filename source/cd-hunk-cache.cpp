@@ -0,0 +1,259 @@
+#include "cd-hunk-cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <system_error>
+#include <utility>
+
+void CDHunkCache::Worker()
+{
+	// The error callback is not thread-safe.
+	CDReader::errors_silenced = true;
+
+	CDReader reader(path);
+
+	// Hunks are only waited on once a worker has started decoding them, so the emulator will just read them itself.
+	if (!reader.IsOpen())
+		return;
+
+	std::vector<cc_u16l> words(HUNK_SIZE_IN_WORDS);
+
+	std::unique_lock lock(mutex);
+
+	for (;;)
+	{
+		work_available.wait(lock, [&]() { return stopping || !queue.empty(); });
+
+		if (stopping)
+			break;
+
+		const auto hunk_index = queue.front();
+		queue.pop_front();
+
+		const auto found = hunk_lookup.find(hunk_index);
+
+		// The prefetch may have been cancelled, or the hunk may have been queued again after that.
+		if (found == std::end(hunk_lookup) || found->second->state != HunkState::QUEUED)
+			continue;
+
+		// Hunks that are being decoded are never evicted or cancelled, so this iterator will remain valid.
+		const auto hunk = found->second;
+		hunk->state = HunkState::DECODING;
+
+		lock.unlock();
+
+		const auto start_time = std::chrono::steady_clock::now();
+
+		reader.SeekToSector(hunk_index * SECTORS_PER_HUNK);
+
+		for (cc_u16f i = 0; i < SECTORS_PER_HUNK; ++i)
+			reader.ReadSector(&words[i * SECTOR_SIZE_IN_WORDS]);
+
+		const auto decode_time = std::chrono::steady_clock::now() - start_time;
+
+		lock.lock();
+
+		std::swap(hunk->words, words);
+		words.resize(HUNK_SIZE_IN_WORDS);
+		hunk->state = HunkState::READY;
+
+		++statistics.hunks_decoded;
+		statistics.total_decode_time += decode_time;
+
+		Evict();
+
+		hunk_decoded.notify_all();
+	}
+}
+
+void CDHunkCache::Prefetch(const CDReader::SectorIndex first_hunk_index)
+{
+	// Keep every worker busy, with a little extra so that there is no gap when one finishes.
+	const auto total_hunks_ahead = std::min<std::size_t>(std::size(workers) * 2, maximum_hunks);
+
+	for (std::size_t i = 0; i < total_hunks_ahead; ++i)
+	{
+		const auto hunk_index = first_hunk_index + i;
+
+		if (hunk_lookup.contains(hunk_index))
+			continue;
+
+		hunks.push_front({hunk_index, HunkState::QUEUED, {}});
+		hunk_lookup[hunk_index] = std::begin(hunks);
+		queue.push_back(hunk_index);
+		work_available.notify_one();
+	}
+
+	Evict();
+}
+
+void CDHunkCache::CancelPrefetches()
+{
+	for (const auto hunk_index : queue)
+	{
+		const auto found = hunk_lookup.find(hunk_index);
+
+		if (found != std::end(hunk_lookup) && found->second->state == HunkState::QUEUED)
+		{
+			hunks.erase(found->second);
+			hunk_lookup.erase(found);
+		}
+	}
+
+	queue.clear();
+}
+
+void CDHunkCache::Evict()
+{
+	// Discard the least-recently-used decoded hunks until the cache is back within its limit.
+	for (auto hunk = std::end(hunks); std::size(hunks) > maximum_hunks && hunk != std::begin(hunks); )
+	{
+		--hunk;
+
+		if (hunk->state == HunkState::READY)
+		{
+			hunk_lookup.erase(hunk->index);
+			hunk = hunks.erase(hunk);
+		}
+	}
+
+	statistics.cached_hunks = std::size(hunks);
+	statistics.maximum_cached_hunks = maximum_hunks;
+}
+
+std::size_t CDHunkCache::SizeToHunks(const std::size_t size_in_megabytes)
+{
+	return std::max<std::size_t>(1, size_in_megabytes * 1024 * 1024 / (HUNK_SIZE_IN_WORDS * sizeof(cc_u16l)));
+}
+
+CDHunkCache::~CDHunkCache()
+{
+	Close();
+}
+
+bool CDHunkCache::Open(const std::filesystem::path &path, const std::size_t size_in_megabytes)
+{
+	Close();
+
+	if (size_in_megabytes == 0)
+		return false;
+
+	this->path = path;
+	maximum_hunks = SizeToHunks(size_in_megabytes);
+	statistics = {};
+	statistics.maximum_cached_hunks = maximum_hunks;
+
+	// Leave a core for the emulator itself.
+	const auto total_workers = std::clamp(std::thread::hardware_concurrency(), 2u, 5u) - 1;
+
+	try
+	{
+		for (unsigned int i = 0; i < total_workers; ++i)
+			workers.emplace_back(&CDHunkCache::Worker, this);
+	}
+	catch (const std::system_error&)
+	{
+		// Threads are unavailable, so just let the emulator decode the hunks itself.
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void CDHunkCache::Close()
+{
+	{
+		const std::lock_guard lock(mutex);
+		stopping = true;
+	}
+
+	work_available.notify_all();
+
+	for (auto &worker : workers)
+		worker.join();
+
+	workers.clear();
+	hunks.clear();
+	hunk_lookup.clear();
+	queue.clear();
+	last_missed_hunk_index = std::nullopt;
+	stopping = false;
+}
+
+void CDHunkCache::SetSize(const std::size_t size_in_megabytes)
+{
+	const std::lock_guard lock(mutex);
+
+	maximum_hunks = SizeToHunks(size_in_megabytes);
+	Evict();
+}
+
+bool CDHunkCache::ReadSector(const CDReader::SectorIndex sector_index, cc_u16l* const buffer)
+{
+	const auto hunk_index = sector_index / SECTORS_PER_HUNK;
+
+	std::unique_lock lock(mutex);
+
+	const auto found = hunk_lookup.find(hunk_index);
+	bool hit = false;
+
+	if (found != std::end(hunk_lookup) && found->second->state != HunkState::QUEUED)
+	{
+		const auto hunk = found->second;
+
+		// A worker is already part-way through this hunk, so waiting for it is faster than decoding it again.
+		hunk_decoded.wait(lock, [&]() { return hunk->state == HunkState::READY; });
+
+		const auto sector_words = &hunk->words[sector_index % SECTORS_PER_HUNK * SECTOR_SIZE_IN_WORDS];
+		std::copy(sector_words, sector_words + SECTOR_SIZE_IN_WORDS, buffer);
+
+		hunks.splice(std::begin(hunks), hunks, hunk);
+		hit = true;
+	}
+
+	if (hit)
+	{
+		++statistics.hits;
+		last_missed_hunk_index = std::nullopt;
+	}
+	else
+	{
+		++statistics.misses;
+
+		if (found != std::end(hunk_lookup))
+		{
+			// The workers have fallen behind, but the prediction was right. The emulator is about to decode this hunk
+			// itself, so there is no point in a worker doing it too.
+			hunks.erase(found->second);
+			hunk_lookup.erase(found);
+		}
+		else if (last_missed_hunk_index != hunk_index)
+		{
+			// The emulator has jumped somewhere that we did not predict, so stop decoding the old location.
+			CancelPrefetches();
+		}
+
+		last_missed_hunk_index = hunk_index;
+	}
+
+	// Always keep the next few hunks in flight. On a miss, the emulator's own reader has decoded the current hunk,
+	// so it reads the rest of it from there, and the workers start on the hunk after it.
+	Prefetch(hunk_index + 1);
+
+	return hit;
+}
+
+CDHunkCache::Statistics CDHunkCache::GetStatistics() const
+{
+	const std::lock_guard lock(mutex);
+	return statistics;
+}
+
+bool CDHunkCache::IsCompressedImage(const std::filesystem::path &path)
+{
+	auto extension = path.extension().string();
+	std::transform(std::begin(extension), std::end(extension), std::begin(extension), [](const unsigned char character) { return std::tolower(character); });
+	return extension == ".chd";
+}
@@ -0,0 +1,95 @@
+#ifndef CD_HUNK_CACHE_H
+#define CD_HUNK_CACHE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "cd-reader.h"
+
+// Decompresses hunks of a compressed CD image ahead of the emulator on a pool of worker threads,
+// and keeps the decoded hunks in an LRU cache. Each worker has its own CDReader, so codecs run
+// in parallel across hunks without touching the emulator's reader.
+class CDHunkCache
+{
+public:
+	// This matches the hunk size that 'chdman' uses for CDs.
+	static constexpr cc_u16f SECTORS_PER_HUNK = 8;
+	static constexpr std::size_t SECTOR_SIZE_IN_WORDS = CDReader::SECTOR_SIZE / 2;
+	static constexpr std::size_t HUNK_SIZE_IN_WORDS = SECTORS_PER_HUNK * SECTOR_SIZE_IN_WORDS;
+
+	struct Statistics
+	{
+		cc_u32f hits = 0;
+		cc_u32f misses = 0;
+		cc_u32f hunks_decoded = 0;
+		std::chrono::steady_clock::duration total_decode_time = {};
+		std::size_t cached_hunks = 0;
+		std::size_t maximum_cached_hunks = 0;
+	};
+
+private:
+	enum class HunkState
+	{
+		QUEUED,
+		DECODING,
+		READY
+	};
+
+	struct Hunk
+	{
+		CDReader::SectorIndex index;
+		HunkState state;
+		std::vector<cc_u16l> words;
+	};
+
+	using HunkList = std::list<Hunk>;
+
+	std::filesystem::path path;
+	// Most-recently-used hunks are at the front.
+	HunkList hunks;
+	std::unordered_map<CDReader::SectorIndex, HunkList::iterator> hunk_lookup;
+	std::deque<CDReader::SectorIndex> queue;
+	std::vector<std::thread> workers;
+	mutable std::mutex mutex;
+	std::condition_variable work_available;
+	std::condition_variable hunk_decoded;
+	bool stopping = false;
+	std::size_t maximum_hunks = 0;
+	// The emulator reads the rest of a hunk that it missed by itself, so those reads are not treated as a jump.
+	std::optional<CDReader::SectorIndex> last_missed_hunk_index;
+	Statistics statistics;
+
+	void Worker();
+	void Prefetch(CDReader::SectorIndex first_hunk_index);
+	void CancelPrefetches();
+	void Evict();
+	static std::size_t SizeToHunks(std::size_t size_in_megabytes);
+
+public:
+	CDHunkCache() = default;
+	~CDHunkCache();
+	CDHunkCache(const CDHunkCache &other) = delete;
+	CDHunkCache(CDHunkCache &&other) = delete;
+	CDHunkCache& operator=(const CDHunkCache &other) = delete;
+	CDHunkCache& operator=(CDHunkCache &&other) = delete;
+
+	bool Open(const std::filesystem::path &path, std::size_t size_in_megabytes);
+	void Close();
+	[[nodiscard]] bool IsOpen() const { return !workers.empty(); }
+	void SetSize(std::size_t size_in_megabytes);
+	// Returns false if the sector is not cached, in which case it should be read directly instead.
+	[[nodiscard]] bool ReadSector(CDReader::SectorIndex sector_index, cc_u16l *buffer);
+	[[nodiscard]] Statistics GetStatistics() const;
+	[[nodiscard]] static bool IsCompressedImage(const std::filesystem::path &path);
+};
+
+#endif /* CD_HUNK_CACHE_H */
@@ -1,9 +1,109 @@
 #include "cd-reader.h"
 
+#include <algorithm>
+#include <array>
+#include <cctype>
 #include <climits>
+#include <string>
+#include <system_error>
+
+#include "disc-preloader.h"
 
 CDReader::ErrorCallback CDReader::error_callback;
 
+std::optional<Hash::Digests> CDReader::HashDataTrack()
+{
+	if (!SeekToSector(0))
+		return std::nullopt;
+
+	Hash::Hasher hasher;
+	std::array<cc_u16l, SECTOR_SIZE / 2> sector;
+
+	for (SectorIndex i = 0; i < SECTORS_TO_HASH; ++i)
+	{
+		ReadSector(std::data(sector));
+		hasher.Update(std::data(sector), std::size(sector));
+	}
+
+	return hasher.Finish();
+}
+
+std::uintmax_t CDReader::GetImageSize(const std::filesystem::path &path)
+{
+	std::uintmax_t total_size = 0;
+
+	const auto &AddFileSize = [&](const std::filesystem::path &file_path)
+	{
+		std::error_code error;
+		const auto size = std::filesystem::file_size(file_path, error);
+
+		if (!error)
+			total_size += size;
+	};
+
+	AddFileSize(path);
+
+	auto extension = path.extension().string();
+	std::transform(std::begin(extension), std::end(extension), std::begin(extension), [](const unsigned char character) { return std::tolower(character); });
+
+	if (extension == ".cue")
+		for (const auto &track_path : GetCueSheetFiles(path))
+			AddFileSize(track_path);
+
+	return total_size;
+}
+
+std::vector<std::filesystem::path> CDReader::GetCueSheetFiles(const std::filesystem::path &cue_path)
+{
+	SDL::IOStream file(cue_path, "rb");
+
+	if (!file)
+		return {};
+
+	// Cue sheets are tiny, so anything large is not really a cue sheet.
+	const auto size = SDL_GetIOSize(file);
+
+	if (size <= 0 || size > 0x10000)
+		return {};
+
+	std::string contents(size, '\0');
+	if (SDL_ReadIO(file, std::data(contents), std::size(contents)) != std::size(contents))
+		return {};
+
+	std::vector<std::filesystem::path> paths;
+	std::string_view remaining = contents;
+
+	while (!remaining.empty())
+	{
+		const auto line_end = remaining.find_first_of("\r\n");
+		auto line = remaining.substr(0, line_end);
+		remaining.remove_prefix(line_end == std::string_view::npos ? std::size(remaining) : line_end + 1);
+
+		line.remove_prefix(std::min(line.find_first_not_of(" \t"), std::size(line)));
+
+		if (!line.starts_with("FILE "))
+			continue;
+
+		line.remove_prefix(5);
+
+		std::string_view filename;
+
+		if (line.starts_with('"'))
+		{
+			line.remove_prefix(1);
+			filename = line.substr(0, line.find('"'));
+		}
+		else
+		{
+			filename = line.substr(0, line.find(' '));
+		}
+
+		paths.push_back(cue_path.parent_path() / FileUtilities::U8Path(filename));
+	}
+
+	return paths;
+}
+
 void* CDReader::FileOpenCallback(const char* const filename, const ClownCD_FileMode mode)
 {
 	const char *mode_string;
@@ -11,6 +111,10 @@ void* CDReader::FileOpenCallback(const char* const filename, const ClownCD_FileM
 	switch (mode)
 	{
 		case CLOWNCD_RB:
+			// Files of a disc that is being preloaded into RAM are read from there instead.
+			if (const auto stream = DiscPreloader::OpenFile(FileUtilities::U8Path(filename)); stream != nullptr)
+				return stream;
+
 			mode_string = "rb";
 			break;
 
@@ -2,13 +2,17 @@
 #define CD_READER_H
 
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
+#include <optional>
 #include <string_view>
+#include <vector>
 
 #include "../common/cd-reader.h"
 
 #include "file-utilities.h"
+#include "hash.h"
 #include "sdl-wrapper.h"
 
 class CDReader : private CDReader_State
@@ -113,6 +117,13 @@ public:
 	{
 		return CDReader_ReadMegaCDHeaderSector(this, buffer);
 	}
+	// Hashing whole discs would take far too long, so only the start of the first data track is hashed.
+	// This holds the disc header and boot program, which is enough to tell discs apart.
+	static constexpr SectorIndex SECTORS_TO_HASH = 0x200;
+	[[nodiscard]] std::optional<Hash::Digests> HashDataTrack();
+	// Revisions of a disc can share the sectors that are hashed, so this is used to tell them apart as well.
+	// It is the total size of the disc image's files, including the track files of a cue sheet.
+	[[nodiscard]] static std::uintmax_t GetImageSize(const std::filesystem::path &path);
 	[[nodiscard]] bool IsMegaCDGame()
 	{
 		return CDReader_IsMegaCDGame(this);
@@ -129,6 +140,8 @@ public:
 	{
 		return CDReader(path).IsDefinitelyACD();
 	}
+	// Returns the paths of the track files that a cue sheet lists.
+	[[nodiscard]] static std::vector<std::filesystem::path> GetCueSheetFiles(const std::filesystem::path &cue_path);
 
 	////////////////////
 	// Error Callback //
@@ -141,13 +154,17 @@ private:
 	static ErrorCallback error_callback;
 
 public:
+	// Worker threads which read discs set this, as the error callback is not thread-safe.
+	static inline thread_local bool errors_silenced = false;
+
 	static void SetErrorCallback(const ErrorCallback &callback)
 	{
 		error_callback = callback;
 		CDReader_SetErrorCallback(
 			[](void* const user_data, const char *message)
 			{
-				(*static_cast<const ErrorCallback*>(user_data))(message);
+				if (!errors_silenced)
+					(*static_cast<const ErrorCallback*>(user_data))(message);
 			}, &error_callback
 		);
 	}
@@ -0,0 +1,220 @@
+#include "cdda-stream.h"
+
+#include <algorithm>
+#include <iterator>
+#include <system_error>
+
+void CDDAStream::Producer()
+{
+	// The error callback is not thread-safe.
+	CDReader::errors_silenced = true;
+
+	// Nothing else touches the mirror reader until it is marked as open.
+	reader.Open(path);
+
+	{
+		const std::lock_guard reader_lock(reader_mutex);
+		reader_open = reader.IsOpen();
+	}
+
+	// The emulator will just decode the audio itself.
+	if (!reader_open)
+		return;
+
+	std::unique_lock signal_lock(signal_mutex);
+
+	for (;;)
+	{
+		space_available.wait(signal_lock, [&]() { return stopping || HasSpace(); });
+
+		if (stopping)
+			break;
+
+		signal_lock.unlock();
+		ProduceChunk();
+		signal_lock.lock();
+	}
+}
+
+void CDDAStream::ProduceChunk()
+{
+	const std::lock_guard reader_lock(reader_mutex);
+
+	// The stream may have been reset while we were waiting for the lock.
+	if (!HasSpace())
+		return;
+
+	// Chunks are always written whole (except for the last one), so they never straddle the end of the ring.
+	const auto position = write_position.load(std::memory_order_relaxed);
+	const auto total_frames = reader.ReadAudio(&ring[position % RING_SIZE_IN_FRAMES * TOTAL_CHANNELS], CHUNK_SIZE_IN_FRAMES);
+
+	const auto checkpoint_index = checkpoint_write_index.load(std::memory_order_relaxed);
+	auto &checkpoint = checkpoints[checkpoint_index % std::size(checkpoints)];
+	checkpoint.position = position + total_frames;
+	checkpoint.state.emplace(reader);
+	checkpoint_write_index.store(checkpoint_index + 1, std::memory_order_release);
+
+	write_position.store(position + total_frames, std::memory_order_release);
+
+	// A short read means that playback has finished.
+	if (total_frames != CHUNK_SIZE_IN_FRAMES)
+		ended.store(true, std::memory_order_release);
+}
+
+bool CDDAStream::HasSpace() const
+{
+	const auto frames_queued = write_position.load(std::memory_order_relaxed) - read_position.load(std::memory_order_acquire);
+	const auto checkpoints_queued = checkpoint_write_index.load(std::memory_order_relaxed) - checkpoint_read_index.load(std::memory_order_acquire);
+
+	return playing && !ended && RING_SIZE_IN_FRAMES - frames_queued >= CHUNK_SIZE_IN_FRAMES && checkpoints_queued < std::size(checkpoints);
+}
+
+void CDDAStream::Reset(const bool playing)
+{
+	write_position = 0;
+	read_position = 0;
+	checkpoint_write_index = 0;
+	checkpoint_read_index = 0;
+	ended = false;
+	this->playing = playing;
+}
+
+void CDDAStream::Signal(std::condition_variable &condition_variable)
+{
+	// Taking the lock prevents the wake-up from being missed by a thread that is about to sleep.
+	{
+		const std::lock_guard signal_lock(signal_mutex);
+	}
+
+	condition_variable.notify_all();
+}
+
+CDDAStream::~CDDAStream()
+{
+	Close();
+}
+
+bool CDDAStream::Open(const std::filesystem::path &path)
+{
+	Close();
+
+	this->path = path;
+
+	try
+	{
+		thread = std::thread(&CDDAStream::Producer, this);
+	}
+	catch (const std::system_error&)
+	{
+		// Threads are unavailable, so just let the emulator decode the audio itself.
+		return false;
+	}
+
+	return true;
+}
+
+void CDDAStream::Close()
+{
+	if (IsOpen())
+	{
+		stopping = true;
+		Signal(space_available);
+		thread.join();
+		stopping = false;
+	}
+
+	reader.Close();
+	reader_open = false;
+	Reset(false);
+}
+
+void CDDAStream::Resynchronise(const CDReader &emulator_reader)
+{
+	if (!IsOpen())
+		return;
+
+	{
+		const std::lock_guard reader_lock(reader_mutex);
+
+		// Until the mirror reader is open, the emulator decodes the audio itself.
+		if (!reader_open)
+			return;
+
+		CDReader::StateBackup(emulator_reader).Apply(reader);
+		Reset(true);
+	}
+
+	Signal(space_available);
+}
+
+void CDDAStream::Stop()
+{
+	if (!IsOpen())
+		return;
+
+	const std::lock_guard reader_lock(reader_mutex);
+	Reset(false);
+}
+
+std::optional<std::size_t> CDDAStream::Read(CDReader &emulator_reader, cc_s16l* const sample_buffer, const std::size_t total_frames)
+{
+	if (!IsOpen() || !playing)
+		return std::nullopt;
+
+	std::size_t frames_done = 0;
+
+	while (frames_done != total_frames)
+	{
+		// This must be checked before the write position, as the producer sets it after writing the final chunk.
+		const bool finished = ended.load(std::memory_order_acquire);
+		const auto position = read_position.load(std::memory_order_relaxed);
+		const auto frames_available = write_position.load(std::memory_order_acquire) - position;
+
+		if (frames_available == 0)
+		{
+			if (finished)
+				break;
+
+			// The producer has fallen behind, such as just after a seek, so play silence rather than wait for it.
+			// Waiting would put the cost of decoding back onto the frame, and would freeze the emulator if the producer stalled.
+			std::fill(&sample_buffer[frames_done * TOTAL_CHANNELS], &sample_buffer[total_frames * TOTAL_CHANNELS], 0);
+			frames_done = total_frames;
+			break;
+		}
+
+		const auto frames_to_copy = std::min<std::size_t>({frames_available, total_frames - frames_done, RING_SIZE_IN_FRAMES - position % RING_SIZE_IN_FRAMES});
+		const auto source = &ring[position % RING_SIZE_IN_FRAMES * TOTAL_CHANNELS];
+
+		std::copy(source, source + frames_to_copy * TOTAL_CHANNELS, &sample_buffer[frames_done * TOTAL_CHANNELS]);
+		frames_done += frames_to_copy;
+
+		read_position.store(position + frames_to_copy, std::memory_order_release);
+	}
+
+	// Bring the emulator's reader up to the latest checkpoint that has been played, so that save states
+	// resume from the right place. This is accurate to within one chunk.
+	const auto played_position = read_position.load(std::memory_order_relaxed);
+	const auto checkpoint_end = checkpoint_write_index.load(std::memory_order_acquire);
+	auto checkpoint_index = checkpoint_read_index.load(std::memory_order_relaxed);
+	const Checkpoint *latest_checkpoint = nullptr;
+
+	for (; checkpoint_index != checkpoint_end; ++checkpoint_index)
+	{
+		const auto &checkpoint = checkpoints[checkpoint_index % std::size(checkpoints)];
+
+		if (checkpoint.position > played_position)
+			break;
+
+		latest_checkpoint = &checkpoint;
+	}
+
+	// This must be done before the checkpoint is released back to the producer.
+	if (latest_checkpoint != nullptr)
+		latest_checkpoint->state->Apply(emulator_reader);
+
+	checkpoint_read_index.store(checkpoint_index, std::memory_order_release);
+
+	Signal(space_available);
+
+	return frames_done;
+}
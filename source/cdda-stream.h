@@ -0,0 +1,84 @@
+#ifndef CDDA_STREAM_H
+#define CDDA_STREAM_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "cd-reader.h"
+
+// Decodes CD audio ahead of the emulator on its own thread, using a second CDReader that mirrors
+// the emulator's one. The decoded audio is passed back through a lock-free single-producer
+// single-consumer ring buffer, so the cost of decoding never lands in the frame loop.
+class CDDAStream
+{
+private:
+	static constexpr cc_u8f TOTAL_CHANNELS = 2;
+	// One sector's worth of audio.
+	static constexpr cc_u32f CHUNK_SIZE_IN_FRAMES = 588;
+	static constexpr std::size_t TOTAL_CHUNKS = 16;
+	static constexpr cc_u32f RING_SIZE_IN_FRAMES = CHUNK_SIZE_IN_FRAMES * TOTAL_CHUNKS;
+
+	// The state of the mirror reader at the end of each chunk, so that the emulator's reader can be
+	// kept roughly in sync with what has actually been played. This is what ends-up in save states.
+	struct Checkpoint
+	{
+		cc_u32f position;
+		std::optional<CDReader::StateBackup> state;
+	};
+
+	std::filesystem::path path;
+	CDReader reader;
+	std::thread thread;
+
+	std::array<cc_s16l, RING_SIZE_IN_FRAMES * TOTAL_CHANNELS> ring;
+	std::atomic<cc_u32f> write_position = 0;
+	std::atomic<cc_u32f> read_position = 0;
+
+	std::array<Checkpoint, TOTAL_CHUNKS + 1> checkpoints;
+	std::atomic<std::size_t> checkpoint_write_index = 0;
+	std::atomic<std::size_t> checkpoint_read_index = 0;
+
+	std::atomic<bool> playing = false;
+	std::atomic<bool> ended = false;
+	std::atomic<bool> stopping = false;
+
+	// Held by the producer while it uses the mirror reader, and by the consumer while it resets the stream.
+	std::mutex reader_mutex;
+	// The mirror reader is opened by the producer, so that parsing the disc again does not hold up the emulator.
+	bool reader_open = false;
+	// Only used for sleeping and waking the producer: the ring buffer itself does not need it.
+	std::mutex signal_mutex;
+	std::condition_variable space_available;
+
+	void Producer();
+	void ProduceChunk();
+	[[nodiscard]] bool HasSpace() const;
+	void Reset(bool playing);
+	void Signal(std::condition_variable &condition_variable);
+
+public:
+	CDDAStream() = default;
+	~CDDAStream();
+	CDDAStream(const CDDAStream &other) = delete;
+	CDDAStream(CDDAStream &&other) = delete;
+	CDDAStream& operator=(const CDDAStream &other) = delete;
+	CDDAStream& operator=(CDDAStream &&other) = delete;
+
+	bool Open(const std::filesystem::path &path);
+	void Close();
+	[[nodiscard]] bool IsOpen() const { return thread.joinable(); }
+	// Discards any decoded audio and continues from wherever the emulator's reader is.
+	void Resynchronise(const CDReader &emulator_reader);
+	void Stop();
+	// Returns nothing if the stream is inactive, in which case the emulator's reader should be used directly.
+	// This never waits for the producer: if it has fallen behind, then the shortfall is filled with silence.
+	[[nodiscard]] std::optional<std::size_t> Read(CDReader &emulator_reader, cc_s16l *sample_buffer, std::size_t total_frames);
+};
+
+#endif /* CDDA_STREAM_H */
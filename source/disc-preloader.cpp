@@ -0,0 +1,383 @@
+#include "disc-preloader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <new>
+#include <string>
+#include <system_error>
+
+#include "cd-reader.h"
+
+Sint64 DiscPreloader::SizeCallback(void* const user_data)
+{
+	auto &preloader = *static_cast<DiscPreloader*>(user_data);
+
+	return SDL_GetIOSize(preloader.current_stream);
+}
+
+Sint64 DiscPreloader::SeekCallback(void* const user_data, const Sint64 offset, const SDL_IOWhence whence)
+{
+	auto &preloader = *static_cast<DiscPreloader*>(user_data);
+
+	return SDL_SeekIO(preloader.current_stream, offset, whence);
+}
+
+std::size_t DiscPreloader::ReadCallback(void* const user_data, void* const pointer, const std::size_t size, SDL_IOStatus* const status)
+{
+	auto &preloader = *static_cast<DiscPreloader*>(user_data);
+
+	const auto bytes_read = SDL_ReadIO(preloader.current_stream, pointer, size);
+
+	if (bytes_read != size)
+		*status = SDL_GetIOStatus(preloader.current_stream);
+
+	return bytes_read;
+}
+
+std::size_t DiscPreloader::WriteCallback([[maybe_unused]] void* const user_data, [[maybe_unused]] const void* const pointer, [[maybe_unused]] const std::size_t size, SDL_IOStatus* const status)
+{
+	*status = SDL_IO_STATUS_READONLY;
+	return 0;
+}
+
+bool DiscPreloader::CloseCallback([[maybe_unused]] void* const user_data)
+{
+	// The underlying streams are owned by the preloader, so there is nothing to do here.
+	return true;
+}
+
+/////////////////////
+// Preloaded Files //
+/////////////////////
+
+Sint64 DiscPreloader::PreloadedFileSizeCallback(void* const user_data)
+{
+	const auto &stream = *static_cast<PreloadedFileStream*>(user_data);
+
+	return stream.file->size;
+}
+
+Sint64 DiscPreloader::PreloadedFileSeekCallback(void* const user_data, const Sint64 offset, const SDL_IOWhence whence)
+{
+	auto &stream = *static_cast<PreloadedFileStream*>(user_data);
+
+	Sint64 position;
+
+	switch (whence)
+	{
+		case SDL_IO_SEEK_SET:
+			position = offset;
+			break;
+
+		case SDL_IO_SEEK_CUR:
+			position = stream.position + offset;
+			break;
+
+		case SDL_IO_SEEK_END:
+			position = stream.file->size + offset;
+			break;
+
+		default:
+			return -1;
+	}
+
+	if (position < 0)
+		return -1;
+
+	// Keep the file handle in step, so that reading from it does not need a seek each time.
+	if (!stream.file->complete && SDL_SeekIO(stream.fallback, position, SDL_IO_SEEK_SET) == -1)
+		return -1;
+
+	stream.position = position;
+	return position;
+}
+
+std::size_t DiscPreloader::PreloadedFileReadCallback(void* const user_data, void* const pointer, const std::size_t size, SDL_IOStatus* const status)
+{
+	auto &stream = *static_cast<PreloadedFileStream*>(user_data);
+	const auto &file = *stream.file;
+
+	std::size_t bytes_read;
+
+	if (file.complete)
+	{
+		// The RAM copy is never modified once it is complete, so it can be read without locking.
+		const auto bytes_remaining = static_cast<std::size_t>(std::max<Sint64>(0, static_cast<Sint64>(std::size(file.buffer)) - stream.position));
+		bytes_read = std::min(size, bytes_remaining);
+
+		if (bytes_read != 0)
+			std::copy_n(std::data(file.buffer) + stream.position, bytes_read, static_cast<unsigned char*>(pointer));
+
+		if (bytes_read != size)
+			*status = SDL_IO_STATUS_EOF;
+	}
+	else
+	{
+		bytes_read = SDL_ReadIO(stream.fallback, pointer, size);
+
+		if (bytes_read != size)
+			*status = SDL_GetIOStatus(stream.fallback);
+	}
+
+	stream.position += bytes_read;
+	return bytes_read;
+}
+
+bool DiscPreloader::PreloadedFileCloseCallback(void* const user_data)
+{
+	delete static_cast<PreloadedFileStream*>(user_data);
+	return true;
+}
+
+std::filesystem::path DiscPreloader::NormalisePath(const std::filesystem::path &path)
+{
+	// The CD reader builds the paths of track files itself, so they may not be spelt the same way as ours.
+	std::error_code error;
+	const auto absolute_path = std::filesystem::absolute(path, error);
+
+	return (error ? path : absolute_path).lexically_normal();
+}
+
+SDL_IOStream* DiscPreloader::OpenFile(const std::filesystem::path &path)
+{
+	std::shared_ptr<const PreloadedFile> preloaded_file;
+
+	{
+		const std::lock_guard lock(preloaded_files_mutex);
+
+		const auto found = all_preloaded_files.find(NormalisePath(path));
+
+		if (found == std::end(all_preloaded_files))
+			return nullptr;
+
+		preloaded_file = found->second;
+	}
+
+	auto stream = std::make_unique<PreloadedFileStream>();
+	stream->file = preloaded_file;
+
+	// Until the RAM copy is complete, the file is read from a handle of its own.
+	if (!preloaded_file->complete)
+	{
+		stream->fallback = SDL::IOStream(preloaded_file->path, "rb");
+
+		if (!stream->fallback)
+			return nullptr;
+	}
+
+	SDL_IOStreamInterface interface;
+	SDL_INIT_INTERFACE(&interface);
+	interface.size = PreloadedFileSizeCallback;
+	interface.seek = PreloadedFileSeekCallback;
+	interface.read = PreloadedFileReadCallback;
+	interface.close = PreloadedFileCloseCallback;
+
+	SDL_IOStream* const io_stream = SDL_OpenIO(&interface, stream.get());
+
+	// The stream now owns this, and frees it when it is closed.
+	if (io_stream != nullptr)
+		stream.release();
+
+	return io_stream;
+}
+
+////////////////
+// Preloading //
+////////////////
+
+bool DiscPreloader::PreloadFile(PreloadedFile &preloaded_file)
+{
+	// Use a separate handle so that the emulator can keep reading from the original one in the meantime.
+	SDL::IOStream preload_file(preloaded_file.path, "rb");
+
+	if (!preload_file)
+		return false;
+
+	try
+	{
+		preloaded_file.buffer.resize(static_cast<std::size_t>(preloaded_file.size));
+	}
+	catch (const std::bad_alloc&)
+	{
+		return false;
+	}
+
+	// Read in chunks so that progress can be reported and so that we can bail out quickly when the disc is ejected.
+	constexpr Sint64 chunk_size = 1024 * 1024;
+
+	for (Sint64 position = 0; position != preloaded_file.size; )
+	{
+		if (cancelled)
+			return false;
+
+		const auto bytes_to_read = static_cast<std::size_t>(std::min(chunk_size, preloaded_file.size - position));
+
+		if (SDL_ReadIO(preload_file, &preloaded_file.buffer[position], bytes_to_read) != bytes_to_read)
+			return false;
+
+		position += bytes_to_read;
+		bytes_loaded += bytes_to_read;
+	}
+
+	preloaded_file.complete = true;
+	return true;
+}
+
+void DiscPreloader::Preload()
+{
+	// Stop at the first failure, as running out of memory for one file means running out for the rest.
+	for (const auto &preloaded_file : preloaded_files)
+		if (!PreloadFile(*preloaded_file))
+			break;
+
+	finished = true;
+}
+
+void DiscPreloader::StopPreloading()
+{
+	cancelled = true;
+
+	if (thread.joinable())
+		thread.join();
+
+	const std::lock_guard lock(preloaded_files_mutex);
+
+	// A newer load of the same disc may have taken these paths over, so only remove our own files.
+	for (const auto &preloaded_file : preloaded_files)
+	{
+		const auto found = all_preloaded_files.find(NormalisePath(preloaded_file->path));
+
+		if (found != std::end(all_preloaded_files) && found->second == preloaded_file)
+			all_preloaded_files.erase(found);
+	}
+}
+
+DiscPreloader::DiscPreloader(SDL::IOStream &&file)
+	: file(std::move(file))
+	, current_stream(this->file)
+{
+	SDL_IOStreamInterface interface;
+	SDL_INIT_INTERFACE(&interface);
+	interface.size = SizeCallback;
+	interface.seek = SeekCallback;
+	interface.read = ReadCallback;
+	interface.write = WriteCallback;
+	interface.close = CloseCallback;
+
+	proxy = SDL::IOStream(SDL_OpenIO(&interface, this));
+}
+
+DiscPreloader::~DiscPreloader()
+{
+	StopPreloading();
+}
+
+void DiscPreloader::StartPreloading(const std::filesystem::path &path)
+{
+	if (preloading || file == nullptr)
+		return;
+
+	const auto &AddFile = [&](const std::filesystem::path &file_path, const Sint64 size)
+	{
+		if (size <= 0)
+			return;
+
+		auto &preloaded_file = *preloaded_files.emplace_back(std::make_shared<PreloadedFile>());
+		preloaded_file.path = file_path;
+		preloaded_file.size = size;
+		total_bytes += size;
+	};
+
+	try
+	{
+		AddFile(path, SDL_GetIOSize(file));
+
+		// A cue sheet only describes the disc: its data is in the track files that it lists.
+		auto extension = path.extension().string();
+		std::transform(std::begin(extension), std::end(extension), std::begin(extension), [](const unsigned char character) { return std::tolower(character); });
+
+		if (!preloaded_files.empty() && extension == ".cue")
+		{
+			for (const auto &track_path : CDReader::GetCueSheetFiles(path))
+			{
+				std::error_code error;
+				const auto size = std::filesystem::file_size(track_path, error);
+
+				if (!error)
+					AddFile(track_path, static_cast<Sint64>(size));
+			}
+		}
+
+		if (preloaded_files.empty())
+			return;
+
+		thread = std::thread(&DiscPreloader::Preload, this);
+	}
+	catch (const std::bad_alloc&)
+	{
+		preloaded_files.clear();
+		return;
+	}
+	catch (const std::system_error&)
+	{
+		// Threads are unavailable, so just keep streaming from the files.
+		preloaded_files.clear();
+		return;
+	}
+
+	{
+		const std::lock_guard lock(preloaded_files_mutex);
+
+		for (const auto &preloaded_file : preloaded_files)
+			all_preloaded_files.insert_or_assign(NormalisePath(preloaded_file->path), preloaded_file);
+	}
+
+	preloading = true;
+}
+
+void DiscPreloader::Update()
+{
+	if (!preloading || !finished || file == nullptr)
+		return;
+
+	thread.join();
+
+	// Anything that was not copied in full is still read from its file, so its partial copy is of no use.
+	for (const auto &preloaded_file : preloaded_files)
+	{
+		if (!preloaded_file->complete)
+		{
+			preloaded_file->buffer.clear();
+			preloaded_file->buffer.shrink_to_fit();
+		}
+	}
+
+	const auto &main_file = *preloaded_files.front();
+
+	if (!main_file.complete)
+	{
+		preloading = false;
+		return;
+	}
+
+	// Switch the CD reader over to the RAM copy, preserving its position within the file.
+	memory = SDL::IOStream(static_cast<const void*>(std::data(main_file.buffer)), std::size(main_file.buffer));
+
+	if (memory == nullptr || SDL_SeekIO(memory, SDL_TellIO(file), SDL_IO_SEEK_SET) == -1)
+	{
+		memory.reset();
+		preloading = false;
+		return;
+	}
+
+	current_stream = memory;
+	file.reset();
+}
+
+std::optional<float> DiscPreloader::GetProgress() const
+{
+	if (!preloading || file == nullptr)
+		return std::nullopt;
+
+	return static_cast<float>(bytes_loaded) / total_bytes;
+}
@@ -0,0 +1,95 @@
+#ifndef DISC_PRELOADER_H
+#define DISC_PRELOADER_H
+
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "sdl-wrapper.h"
+
+// Owns the stream that a CD is read from, and optionally copies the whole disc image into RAM
+// on a worker thread. The CD reader is handed a proxy stream, which is re-pointed at the RAM
+// copy once it is complete, so the swap is invisible to the emulator and needs no reset.
+// For cue sheets, the track files are copied too. While preloading, every file of the disc can be
+// opened with 'OpenFile', so that the CD reader's track files and the emulator's other readers
+// (such as the hunk cache and the CD audio decoder) are served from RAM as well.
+class DiscPreloader
+{
+private:
+	struct PreloadedFile
+	{
+		std::filesystem::path path;
+		Sint64 size;
+		std::vector<unsigned char> buffer;
+		std::atomic<bool> complete = false;
+	};
+
+	// Reads a preloaded file from its own file handle until the RAM copy is complete, and then from the RAM copy.
+	struct PreloadedFileStream
+	{
+		std::shared_ptr<const PreloadedFile> file;
+		SDL::IOStream fallback;
+		Sint64 position = 0;
+	};
+
+	static inline std::mutex preloaded_files_mutex;
+	static inline std::map<std::filesystem::path, std::shared_ptr<PreloadedFile>> all_preloaded_files;
+
+	SDL::IOStream file;
+	SDL::IOStream proxy;
+	SDL_IOStream *current_stream;
+
+	// The first of these is the file that the CD reader is handed.
+	std::vector<std::shared_ptr<PreloadedFile>> preloaded_files;
+	SDL::IOStream memory;
+
+	std::thread thread;
+	std::atomic<Sint64> bytes_loaded = 0;
+	Sint64 total_bytes = 0;
+	std::atomic<bool> finished = false;
+	std::atomic<bool> cancelled = false;
+	bool preloading = false;
+
+	static Sint64 SizeCallback(void *user_data);
+	static Sint64 SeekCallback(void *user_data, Sint64 offset, SDL_IOWhence whence);
+	static std::size_t ReadCallback(void *user_data, void *pointer, std::size_t size, SDL_IOStatus *status);
+	static std::size_t WriteCallback(void *user_data, const void *pointer, std::size_t size, SDL_IOStatus *status);
+	static bool CloseCallback(void *user_data);
+
+	static Sint64 PreloadedFileSizeCallback(void *user_data);
+	static Sint64 PreloadedFileSeekCallback(void *user_data, Sint64 offset, SDL_IOWhence whence);
+	static std::size_t PreloadedFileReadCallback(void *user_data, void *pointer, std::size_t size, SDL_IOStatus *status);
+	static bool PreloadedFileCloseCallback(void *user_data);
+
+	static std::filesystem::path NormalisePath(const std::filesystem::path &path);
+	bool PreloadFile(PreloadedFile &preloaded_file);
+	void Preload();
+	void StopPreloading();
+
+public:
+	DiscPreloader(SDL::IOStream &&file);
+	~DiscPreloader();
+	DiscPreloader(const DiscPreloader &other) = delete;
+	DiscPreloader(DiscPreloader &&other) = delete;
+	DiscPreloader& operator=(const DiscPreloader &other) = delete;
+	DiscPreloader& operator=(DiscPreloader &&other) = delete;
+
+	// Call this before the CD reader is opened, so that it opens the track files through the preloader too.
+	void StartPreloading(const std::filesystem::path &path);
+	// Must be called between frames, as this is where the CD reader is switched over to the RAM copy.
+	void Update();
+
+	[[nodiscard]] SDL::IOStream& GetStream() { return proxy; }
+	[[nodiscard]] std::optional<float> GetProgress() const;
+
+	// Opens a file of a disc that is being preloaded. This is thread-safe.
+	// Returns null if the file is not being preloaded, in which case it should be opened normally.
+	[[nodiscard]] static SDL_IOStream* OpenFile(const std::filesystem::path &path);
+};
+
+#endif /* DISC_PRELOADER_H */
@@ -1,18 +1,26 @@
 #ifndef EMULATOR_EXTENDED_H
 #define EMULATOR_EXTENDED_H
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <optional>
 #include <type_traits>
+#include <vector>
 
 #include "../common/core/source/clownmdemu.h"
 #include "../common/cheat.h"
 
 #include "audio-output.h"
+#include "cd-hunk-cache.h"
 #include "cd-reader.h"
+#include "cdda-stream.h"
 #include "debug-log.h"
+#include "save-data-writer.h"
 #include "sdl-wrapper.h"
 #include "text-encoding.h"
 
@@ -43,15 +51,19 @@ public:
 	public:
 		StateBackup(const EmulatorExtended &emulator)
 			: emulator(emulator)
-			, cd_reader(emulator.cd_reader)
+			, cd_reader(*emulator.cd_reader)
 			, palette(emulator.palette)
 		{}
 
 		void Apply(EmulatorExtended &emulator) const
 		{
 			this->emulator.Apply(emulator);
-			cd_reader.Apply(emulator.cd_reader);
+			cd_reader.Apply(*emulator.cd_reader);
 			emulator.palette = palette;
+
+			// The CD reader's position is not known here, so bypass the hunk cache until the next seek.
+			emulator.cd_sector_index.reset();
+			emulator.cdda_stream.Resynchronise(*emulator.cd_reader);
 		}
 	};
 
@@ -146,14 +158,26 @@ private:
 
 	bool paused = false;
 	cc_u16l *cartridge_buffer;
-	CDReader cd_reader;
+	// This is a pointer so that a disc can be opened on a worker thread and then handed over.
+	std::unique_ptr<CDReader> cd_reader = std::make_unique<CDReader>();
+	CDHunkCache cd_hunk_cache;
+	std::size_t cd_hunk_cache_size = 64; // In megabytes.
+	std::filesystem::path cd_file_path;
+	std::optional<CDReader::SectorIndex> cd_sector_index;
+	unsigned int frames_since_cd_data_transfer = -1;
+	CDDAStream cdda_stream;
 	AudioOutput audio_output;
 	Palette palette;
 	CheatManagerCXX cheat_manager;
 	StateRingBuffer state_rewind_buffer;
-	std::fstream save_data_stream;
+	std::vector<unsigned char> save_data_buffer;
+	std::size_t save_data_position = 0;
+	std::filesystem::path save_data_path;
+	bool save_data_writing = false;
 	std::filesystem::path save_file_directory;
 	std::filesystem::path cartridge_save_file_path;
+	SaveDataWriter cartridge_save_data_writer;
+	std::vector<std::uint_least64_t> cartridge_save_data_page_hashes;
 	unsigned int speed = 1;
 
 	////////////////////////
@@ -184,11 +208,25 @@ private:
 
 	void CDSeeked(cc_u32f sector_index)
 	{
-		cd_reader.SeekToSector(sector_index);
+		// Reading data stops CD audio playback, and the streamed audio would clobber the new position.
+		cdda_stream.Stop();
+
+		cd_reader->SeekToSector(sector_index);
+		cd_sector_index = sector_index;
+		frames_since_cd_data_transfer = 0;
 	}
 	void CDSectorRead(cc_u16l *buffer)
 	{
-		cd_reader.ReadSector(buffer);
+		// Use the pre-decoded hunk if there is one, but keep the CD reader's position in sync for save states.
+		if (cd_sector_index.has_value() && cd_hunk_cache.IsOpen() && cd_hunk_cache.ReadSector(*cd_sector_index, buffer))
+			cd_reader->SeekToSector(*cd_sector_index + 1);
+		else
+			cd_reader->ReadSector(buffer);
+
+		if (cd_sector_index.has_value())
+			++*cd_sector_index;
+
+		frames_since_cd_data_transfer = 0;
 	}
 	cc_bool CDTrackSeeked(cc_u16f track_index, ClownMDEmu_CDDAMode mode)
 	{
@@ -213,39 +251,73 @@ private:
 				break;
 		}
 
-		return cd_reader.PlayAudio(track_index, playback_setting);
+		const bool success = cd_reader->PlayAudio(track_index, playback_setting);
+
+		// Start decoding the new track ahead of time.
+		cdda_stream.Resynchronise(*cd_reader);
+
+		return success;
 	}
 	std::size_t CDAudioRead(cc_s16l *sample_buffer, std::size_t total_frames)
 	{
-		return cd_reader.ReadAudio(sample_buffer, total_frames);
+		const auto frames_read = cdda_stream.Read(*cd_reader, sample_buffer, total_frames);
+
+		if (frames_read.has_value())
+			return *frames_read;
+
+		return cd_reader->ReadAudio(sample_buffer, total_frames);
 	}
 
+	// The core accesses save files a byte at a time, so buffer the whole file in memory
+	// and only touch the disk when it is opened and closed.
 	cc_bool SaveFileOpenedForReading(const char *filename)
 	{
-		save_data_stream.open(save_file_directory / filename, std::ios::binary | std::ios::in);
-		return save_data_stream.is_open();
+		save_data_path = save_file_directory / filename;
+		save_data_position = 0;
+		save_data_writing = false;
+
+		std::ifstream stream(save_data_path, std::ios::binary | std::ios::ate);
+
+		if (!stream.is_open())
+			return cc_false;
+
+		const auto size = stream.tellg();
+
+		if (size == -1)
+			return cc_false;
+
+		save_data_buffer.resize(static_cast<std::size_t>(size));
+		stream.seekg(0);
+		stream.read(reinterpret_cast<char*>(std::data(save_data_buffer)), std::size(save_data_buffer));
+
+		return stream.good();
 	}
 	cc_s16f SaveFileRead()
 	{
-		const auto byte = save_data_stream.get();
-
-		if (save_data_stream.eof())
+		if (save_data_position == std::size(save_data_buffer))
 			return -1;
 
-		return byte;
+		return save_data_buffer[save_data_position++];
 	}
 	cc_bool SaveFileOpenedForWriting(const char *filename)
 	{
-		save_data_stream.open(save_file_directory / filename, std::ios::binary | std::ios::out);
-		return save_data_stream.is_open();
+		save_data_path = save_file_directory / filename;
+		save_data_writing = true;
+		save_data_buffer.clear();
+		return cc_true;
 	}
 	void SaveFileWritten(cc_u8f byte)
 	{
-		save_data_stream.put(byte);
+		save_data_buffer.push_back(byte);
 	}
 	void SaveFileClosed()
 	{
-		save_data_stream.close();
+		if (save_data_writing && !SaveDataWriter::WriteFileAtomically(save_data_path, std::data(save_data_buffer), std::size(save_data_buffer)))
+			debug_log.Log("Could not write save file '{}'", save_data_path.string());
+
+		save_data_writing = false;
+		save_data_buffer.clear();
+		save_data_position = 0;
 	}
 	cc_bool SaveFileRemoved(const char *filename)
 	{
@@ -288,28 +360,100 @@ private:
 					std::ifstream(cartridge_save_file_path, std::ios::binary).read(reinterpret_cast<char*>(std::data(external_ram_buffer)), save_data_size);
 			}
 		}
+
+		// Autosaving should only write the save data once the game has actually changed it.
+		UpdateCartridgeSaveDataHashes();
+	}
+
+	// Returns whether the save data has changed since the last time that this was called.
+	bool UpdateCartridgeSaveDataHashes()
+	{
+		// This is cheap enough to do every few seconds, and avoids keeping a second copy of the buffer to compare against.
+		constexpr std::size_t page_size = 0x1000;
+
+		const auto &external_ram_buffer = this->GetExternalRAM();
+		const auto total_pages = (std::size(external_ram_buffer) + page_size - 1) / page_size;
+
+		bool changed = std::size(cartridge_save_data_page_hashes) != total_pages;
+		cartridge_save_data_page_hashes.resize(total_pages);
+
+		for (std::size_t page = 0; page < total_pages; ++page)
+		{
+			// FNV-1a.
+			std::uint_least64_t hash = 0xCBF29CE484222325;
+
+			const auto page_begin = page * page_size;
+			const auto page_end = std::min(page_begin + page_size, std::size(external_ram_buffer));
+
+			for (auto i = page_begin; i < page_end; ++i)
+			{
+				hash ^= external_ram_buffer[i];
+				hash = (hash * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF;
+			}
+
+			if (cartridge_save_data_page_hashes[page] != hash)
+			{
+				cartridge_save_data_page_hashes[page] = hash;
+				changed = true;
+			}
+		}
+
+		return changed;
+	}
+
+	void ReportCartridgeSaveDataFailures()
+	{
+		const auto &failed_paths = cartridge_save_data_writer.ReportFailures();
+
+		// Forget what was last saved, so that the next autosave writes the save data again even if the game has not changed it.
+		if (std::find(std::begin(failed_paths), std::end(failed_paths), cartridge_save_file_path) != std::end(failed_paths))
+			cartridge_save_data_page_hashes.clear();
+	}
+
+	[[nodiscard]] bool CartridgeHasSaveData()
+	{
+		const auto &external_ram = this->GetState().external_ram;
+
+		return !cartridge_save_file_path.empty() && external_ram.non_volatile && external_ram.size != 0;
 	}
 
 public:
 	void SaveCartridgeSaveData()
 	{
-		if (cartridge_save_file_path.empty())
+		// Make sure that a pending autosave does not overwrite this one.
+		cartridge_save_data_writer.Flush();
+		ReportCartridgeSaveDataFailures();
+
+		if (!CartridgeHasSaveData())
 			return;
 
 		// Write save data to disk.
 		const auto &external_ram = this->GetState().external_ram;
 
-		if (external_ram.non_volatile && external_ram.size != 0)
+		if (!SaveDataWriter::WriteFileAtomically(cartridge_save_file_path, external_ram.buffer, external_ram.size))
 		{
-			std::ofstream save_data_stream(cartridge_save_file_path, std::ios::binary);
-
-			if (!save_data_stream.is_open())
-				debug_log.Log("Could not open save data for writing");
-			else
-				save_data_stream.write(reinterpret_cast<const char*>(external_ram.buffer), external_ram.size);
+			debug_log.Log("Could not write save data");
+			cartridge_save_data_page_hashes.clear();
+		}
+		else
+		{
+			UpdateCartridgeSaveDataHashes();
 		}
 	}
 
+	// Cheap enough to call regularly: the save data is only copied and written (on another thread) if it has changed.
+	void AutosaveCartridgeSaveData()
+	{
+		// Report any previous autosaves that failed, as the writer cannot do so from its own thread.
+		ReportCartridgeSaveDataFailures();
+
+		if (!CartridgeHasSaveData() || !UpdateCartridgeSaveDataHashes())
+			return;
+
+		const auto &external_ram = this->GetState().external_ram;
+		cartridge_save_data_writer.Write(cartridge_save_file_path, std::vector<unsigned char>(external_ram.buffer, external_ram.buffer + external_ram.size));
+	}
+
 	///////////////////
 	// Miscellaneous //
 	///////////////////
@@ -317,13 +461,9 @@ public:
 private:
 	std::string GetSoftwareName()
 	{
-		std::string name_buffer;
-
 		if (this->IsCartridgeInserted() || IsCDInserted())
 		{
 			constexpr cc_u8f name_buffer_size = 0x30;
-			// '*4' for the maximum UTF-8 length.
-			name_buffer.reserve(name_buffer_size * 4);
 
 			std::array<unsigned char, name_buffer_size> in_buffer;
 			in_buffer.fill(' ');
@@ -357,37 +497,10 @@ private:
 				}
 			}
 
-			cc_u32f previous_codepoint = '\0';
-
-			// In Columns, both regions' names are encoded in SHIFT-JIS, so both names are decoded as SHIFT-JIS here.
-			for (cc_u8f in_index = 0, in_bytes_read; in_index < name_buffer_size; in_index += in_bytes_read)
-			{
-				const cc_u32f codepoint = ShiftJISToUTF32(&in_buffer[in_index], &in_bytes_read);
-
-				// Null characters are obviously invalid.
-				if (codepoint == '\0')
-					return {};
-
-				// Eliminate padding (the Sonic games tend to use padding to make the name look good in a hex editor).
-				if (codepoint != ' ' || previous_codepoint != ' ')
-				{
-					const auto utf8_codepoint = UTF32ToUTF8(codepoint);
-
-					if (!utf8_codepoint.has_value())
-						return {};
-
-					name_buffer += *utf8_codepoint;
-				}
-
-				previous_codepoint = codepoint;
-			}
-
-			// Eliminate trailing space.
-			if (!name_buffer.empty() && name_buffer.back() == ' ')
-				name_buffer.pop_back();
+			return DecodeHeaderName(std::data(in_buffer), std::size(in_buffer));
 		}
 
-		return name_buffer;
+		return {};
 	}
 
 	void UpdateTitle()
@@ -406,7 +519,7 @@ public:
 
 		// This should be called before any other ClownMDEmu functions are called!
 		this->SetLogCallback([](const char* const format, std::va_list args) { debug_log.Log(format, args); });
-		cd_reader.SetErrorCallback([](const std::string_view &message) { debug_log.Log("ClownCD: {}", message); });
+		CDReader::SetErrorCallback([](const std::string_view &message) { debug_log.Log("ClownCD: {}", message); });
 	}
 
 	~EmulatorExtended()
@@ -447,14 +560,29 @@ public:
 	// CD //
 	////////
 
-	[[nodiscard]] bool InsertCD(SDL::IOStream &stream, const std::filesystem::path &path)
+	// 'reader' must already have been opened, as that can take a while.
+	[[nodiscard]] bool InsertCD(std::unique_ptr<CDReader> &&reader, const std::filesystem::path &path)
 	{
 		state_rewind_buffer.Clear();
 
-		cd_reader.Open(path, stream);
-		if (!cd_reader.IsOpen())
+		cd_hunk_cache.Close();
+		cd_sector_index.reset();
+		cd_file_path.clear();
+		cdda_stream.Close();
+
+		cd_reader = std::move(reader);
+		if (!cd_reader->IsOpen())
 			return false;
 
+		cdda_stream.Open(path);
+
+		// Compressed images are slow to decode, so do it ahead of time on other threads.
+		if (CDHunkCache::IsCompressedImage(path))
+		{
+			cd_file_path = path;
+			cd_hunk_cache.Open(cd_file_path, cd_hunk_cache_size);
+		}
+
 		HardReset();
 
 		UpdateTitle();
@@ -466,7 +594,12 @@ public:
 	{
 		state_rewind_buffer.Clear();
 
-		cd_reader.Close();
+		cd_hunk_cache.Close();
+		cd_sector_index.reset();
+		cd_file_path.clear();
+		cdda_stream.Close();
+
+		cd_reader->Close();
 
 		if (this->IsCartridgeInserted())
 			HardReset();
@@ -476,7 +609,29 @@ public:
 
 	[[nodiscard]] bool IsCDInserted() const
 	{
-		return cd_reader.IsOpen();
+		return cd_reader->IsOpen();
+	}
+
+	[[nodiscard]] std::size_t GetCDHunkCacheSize() const
+	{
+		return cd_hunk_cache_size;
+	}
+
+	void SetCDHunkCacheSize(const std::size_t size_in_megabytes)
+	{
+		cd_hunk_cache_size = size_in_megabytes;
+
+		if (size_in_megabytes == 0)
+			cd_hunk_cache.Close();
+		else if (cd_hunk_cache.IsOpen())
+			cd_hunk_cache.SetSize(size_in_megabytes);
+		else if (!cd_file_path.empty())
+			cd_hunk_cache.Open(cd_file_path, size_in_megabytes);
+	}
+
+	[[nodiscard]] CDHunkCache::Statistics GetCDHunkCacheStatistics() const
+	{
+		return cd_hunk_cache.GetStatistics();
 	}
 
 	///////////////////
@@ -486,7 +641,7 @@ public:
 	[[nodiscard]] bool ReadMegaCDHeaderSector(unsigned char* const buffer)
 	{
 		// TODO: Make this return an array instead!
-		return cd_reader.ReadMegaCDHeaderSector(buffer);
+		return cd_reader->ReadMegaCDHeaderSector(buffer);
 	}
 
 	void SoftReset(const cc_bool cd_inserted) = delete;
@@ -501,7 +656,7 @@ public:
 		Emulator::HardReset(IsCDInserted());
 	}
 
-	bool Iterate()
+	bool Iterate(const bool muted = false)
 	{
 		for (unsigned int i = 0; i < speed; ++i)
 		{
@@ -523,11 +678,17 @@ public:
 			// Reset the audio buffers so that they can be mixed into.
 			audio_output.MixerBegin();
 
+			if (frames_since_cd_data_transfer != static_cast<unsigned int>(-1))
+				++frames_since_cd_data_transfer;
+
 			cheat_manager.ApplyRAMPatches(this);
 			Emulator::Iterate();
 
 			// Resample, mix, and output the audio for this frame.
-			audio_output.MixerEnd();
+			if (muted)
+				audio_output.MixerDiscard();
+			else
+				audio_output.MixerEnd();
 		}
 
 		return true;
@@ -543,6 +704,12 @@ public:
 		return speed != 1;
 	}
 
+	// Audio tracks are not counted, as they are streamed while the game carries on as normal.
+	[[nodiscard]] unsigned int GetFramesSinceCDDataTransfer() const
+	{
+		return frames_since_cd_data_transfer;
+	}
+
 	void SetPaused(const bool paused)
 	{
 		this->paused = paused;
@@ -558,6 +725,8 @@ public:
 	///////////
 
 	[[nodiscard]] cc_u32f GetAudioAverageFrames() const { return audio_output.GetAverageFrames(); }
+	[[nodiscard]] bool IsAudioPlaying() { return audio_output.IsPlaying(); }
+	[[nodiscard]] cc_u32f GetAudioQueuedFrames() { return audio_output.GetQueuedFrames(); }
 	[[nodiscard]] cc_u32f GetAudioTargetFrames() const { return audio_output.GetTargetFrames(); }
 	[[nodiscard]] cc_u32f GetAudioTotalBufferFrames() const { return audio_output.GetTotalBufferFrames(); }
 	[[nodiscard]] cc_u32f GetAudioSampleRate() const { return audio_output.GetSampleRate(); }
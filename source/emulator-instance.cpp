@@ -2,10 +2,20 @@
 
 #include <algorithm>
 #include <bit>
+#include <chrono>
+#include <cstdint>
 #include <iterator>
+#include <memory>
+#include <string_view>
+#include <system_error>
 #include <utility>
 
+#include <fmt/format.h>
+
+#include "../common/clowncd/libraries/chd/libchdr/deps/miniz-3.1.1/miniz.h"
+
 #include "frontend.h"
+#include "version.h"
 
 void EmulatorInstance::ScanlineRendered(const cc_u16f scanline, const cc_u8l* const pixels, const cc_u16f left_boundary, const cc_u16f right_boundary, const cc_u16f screen_width, const cc_u16f screen_height)
 {
@@ -25,7 +35,12 @@ void EmulatorInstance::ScanlineRendered(const cc_u16f scanline, const cc_u8l* co
 
 cc_bool EmulatorInstance::InputRequested(const cc_u8f player_id, const ClownMDEmu_Button button_id)
 {
-	return input_callback(player_id, button_id);
+	const cc_bool pressed = input_callback(player_id, button_id);
+
+	if (pressed)
+		input_pressed = true;
+
+	return pressed;
 }
 
 EmulatorInstance::EmulatorInstance(
@@ -41,47 +56,287 @@ EmulatorInstance::EmulatorInstance(
 	, framerate_callback(framerate_callback)
 {}
 
-void EmulatorInstance::Update()
+// The drive goes quiet for a few frames between reads, such as when seeking, so do not stop immediately.
+static constexpr unsigned int turbo_loading_idle_frames = 15;
+
+void EmulatorInstance::Update(const bool single_step)
 {
+	// If the CD has finished being copied into RAM, then switch over to it now, while the emulator is between frames.
+	if (cd_stream != nullptr)
+		cd_stream->Update();
+
 	// Lock the texture so that we can write to its pixels later
 	if (!SDL_LockTexture(texture, nullptr, reinterpret_cast<void**>(&framebuffer_texture_pixels), &framebuffer_texture_pitch))
 		framebuffer_texture_pixels = nullptr;
 
 	framebuffer_texture_pitch /= sizeof(SDL::Pixel);
 
+	UpdateBootStateLookup();
+
 	// Run the emulator for a frame
+	input_pressed = false;
 	Iterate();
 
+	UpdateBootStateCapture();
+	boot_state_writer.ReportFailures();
+
+	// While the game is waiting on the CD drive, run it as fast as possible, with the audio muted.
+	// This stops as soon as the player does anything, so that they never lose control.
+	turbo_loading = false;
+
+	if (turbo_loading_enabled && !rewinding && !single_step)
+	{
+		// Only the frame that was just drawn is shown.
+		framebuffer_texture_pixels = nullptr;
+
+		// Leave the rest of the frame for the frontend.
+		const auto time_budget = (GetTVStandard() == CLOWNMDEMU_TV_STANDARD_PAL ? Frontend::DivideByPALFramerate(SDL_NS_PER_SECOND) : Frontend::DivideByNTSCFramerate(SDL_NS_PER_SECOND)) / 2;
+		const auto deadline = SDL_GetTicksNS() + time_budget;
+
+		while (!input_pressed && GetFramesSinceCDDataTransfer() < turbo_loading_idle_frames && SDL_GetTicksNS() < deadline)
+		{
+			Iterate(true);
+			UpdateBootStateCapture();
+			turbo_loading = true;
+		}
+	}
+
 	// Unlock the texture so that we can draw it
 	SDL_UnlockTexture(texture);
 }
 
+static std::shared_future<std::optional<Hash::Digests>> StartHashing(const std::function<std::optional<Hash::Digests>()> &function)
+{
+	try
+	{
+		return std::async(std::launch::async, function).share();
+	}
+	catch (const std::system_error&)
+	{
+		// Threads are unavailable, so just hash here instead.
+		std::promise<std::optional<Hash::Digests>> promise;
+		promise.set_value(function());
+		return promise.get_future().share();
+	}
+}
+
+static std::optional<Hash::Digests> GetFinishedDigests(const std::shared_future<std::optional<Hash::Digests>> &digests)
+{
+	if (!digests.valid() || digests.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return std::nullopt;
+
+	return digests.get();
+}
+
 void EmulatorInstance::LoadCartridgeFile(std::vector<cc_u16l> &&file_buffer, const std::filesystem::path &path)
 {
+	// The console no longer boots from the disc.
+	boot_state_lookup_pending = false;
+	boot_state_capture.reset();
+
+	// The previous hash must finish before its buffer is replaced.
+	cartridge_digests = {};
+
 	rom_file_buffer = std::move(file_buffer);
 	InsertCartridge(path, std::data(rom_file_buffer), std::size(rom_file_buffer));
+
+	// The cartridge is already running by the time that this finishes.
+	cartridge_digests = StartHashing([words = std::data(rom_file_buffer), total_words = std::size(rom_file_buffer)]()
+	{
+		Hash::Hasher hasher;
+		hasher.Update(words, total_words);
+		return std::optional(hasher.Finish());
+	});
 }
 
 void EmulatorInstance::UnloadCartridgeFile()
 {
+	cartridge_digests = {};
+
 	rom_file_buffer.clear();
 	rom_file_buffer.shrink_to_fit();
 
 	EjectCartridge();
 }
 
-bool EmulatorInstance::LoadCDFile(SDL::IOStream &&stream, const std::filesystem::path &path)
+bool EmulatorInstance::LoadCDFile(std::unique_ptr<DiscPreloader> &&stream, std::unique_ptr<CDReader> &&reader, const std::filesystem::path &path, const std::optional<Hash::Digests> &digests, const std::uintmax_t image_size)
 {
+	// The old stream must outlive the old reader, which is replaced by 'InsertCD'.
+	const bool success = InsertCD(std::move(reader), path);
 	cd_stream = std::move(stream);
-	return InsertCD(cd_stream, path);
+
+	if (!success)
+		return false;
+
+	cd_digests = digests;
+	cd_image_size = image_size;
+
+	boot_state_capture.reset();
+
+	// Games which boot from a cartridge do not use the Mega CD's boot code.
+	boot_state_lookup_pending = boot_state_cache_enabled && !IsCartridgeInserted();
+
+	return true;
 }
 
 void EmulatorInstance::UnloadCDFile()
 {
+	boot_state_lookup_pending = false;
+	boot_state_capture.reset();
+
+	cd_digests = std::nullopt;
+
 	EjectCD();
 	cd_stream.reset();
 }
 
+std::optional<float> EmulatorInstance::GetCDPreloadProgress() const
+{
+	if (cd_stream == nullptr)
+		return std::nullopt;
+
+	return cd_stream->GetProgress();
+}
+
+std::optional<Hash::Digests> EmulatorInstance::GetCartridgeDigests() const
+{
+	return GetFinishedDigests(cartridge_digests);
+}
+
+std::optional<Hash::Digests> EmulatorInstance::GetCDDigests() const
+{
+	return cd_digests;
+}
+
+//////////////////////
+// Boot-State Cache //
+//////////////////////
+
+using BootStateMagic = std::array<char, 8>;
+static const BootStateMagic boot_state_magic = {"CMDEBSC"}; // Clownacy Mega Drive Emulator Boot-State Cache
+
+// Give up if the game has not taken control after a minute, as something has probably gone wrong.
+static constexpr unsigned int boot_state_capture_timeout = 60 * 60;
+
+std::filesystem::path EmulatorInstance::GetBootStatePath(const Hash::SHA1::Digest &disc_sha1, const std::uintmax_t disc_image_size) const
+{
+	// Anything which affects how the console boots, or the layout of the state, must be part of the key.
+	// FNV-1a.
+	std::uint_least64_t hash = 0xCBF29CE484222325;
+
+	const auto &HashByte = [&](const unsigned char byte)
+	{
+		hash ^= byte;
+		hash = (hash * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF;
+	};
+
+	const auto &HashInteger = [&](const std::uint_least64_t integer)
+	{
+		for (unsigned int i = 0; i < 8; ++i)
+			HashByte((integer >> (i * 8)) & 0xFF);
+	};
+
+	for (const auto character : std::string_view(VERSION))
+		HashByte(character);
+
+	HashInteger(sizeof(StateBackup));
+
+	for (const auto byte : disc_sha1)
+		HashByte(byte);
+
+	HashInteger(disc_image_size);
+
+	HashInteger(GetRegion());
+	HashInteger(GetTVStandard());
+	HashInteger(GetCDAddOnEnabled());
+
+	return Frontend::GetConfigurationDirectoryPath() / "boot-states" / fmt::format("{:016X}.bin", hash);
+}
+
+bool EmulatorInstance::RestoreBootState(const std::filesystem::path &path)
+{
+	SDL::IOStream file(path, "rb");
+
+	if (!file)
+		return false;
+
+	const auto &file_buffer = FileUtilities::LoadFileToBuffer<unsigned char, 1>(file);
+
+	if (!file_buffer.has_value() || std::size(*file_buffer) < sizeof(boot_state_magic) || !std::equal(std::begin(boot_state_magic), std::end(boot_state_magic), std::begin(*file_buffer)))
+		return false;
+
+	std::vector<unsigned char> state_buffer(sizeof(StateBackup));
+	mz_ulong state_size = std::size(state_buffer);
+
+	if (mz_uncompress(std::data(state_buffer), &state_size, &(*file_buffer)[sizeof(boot_state_magic)], std::size(*file_buffer) - sizeof(boot_state_magic)) != MZ_OK || state_size != sizeof(StateBackup))
+		return false;
+
+	reinterpret_cast<const StateBackup*>(std::data(state_buffer))->Apply(*this);
+	return true;
+}
+
+// The boot code runs from ROM, while games run from work RAM.
+static bool IsRunningFromWorkRAM(const Clown68000_State &m68k)
+{
+	return (m68k.program_counter & 0xFFFFFF) >= 0xFF0000;
+}
+
+void EmulatorInstance::UpdateBootStateLookup()
+{
+	if (!boot_state_lookup_pending)
+		return;
+
+	boot_state_lookup_pending = false;
+
+	if (!cd_digests.has_value())
+		return;
+
+	const auto boot_state_path = GetBootStatePath(cd_digests->sha1, cd_image_size);
+
+	if (RestoreBootState(boot_state_path))
+		debug_log.Log("Skipped the boot sequence using a cached state");
+	else if (!IsRunningFromWorkRAM(GetM68kState()))
+		boot_state_capture = BootStateCapture{cd_digests->sha1, cd_image_size, boot_state_path, 0};
+}
+
+void EmulatorInstance::UpdateBootStateCapture()
+{
+	if (!boot_state_capture.has_value())
+		return;
+
+	// If a setting which affects booting was changed, then this would be filed under the wrong key.
+	if (++boot_state_capture->frames_waited > boot_state_capture_timeout || GetBootStatePath(boot_state_capture->disc_sha1, boot_state_capture->disc_image_size) != boot_state_capture->path)
+	{
+		boot_state_capture.reset();
+		return;
+	}
+
+	// Wait until the game has taken control from the boot code.
+	if (!IsRunningFromWorkRAM(GetM68kState()))
+		return;
+
+	// Allocate on the heap to prevent stack exhaustion.
+	const auto &state = std::make_unique<StateBackup>(*this);
+
+	std::vector<unsigned char> file_buffer(sizeof(boot_state_magic) + mz_compressBound(sizeof(*state)));
+	std::copy(std::begin(boot_state_magic), std::end(boot_state_magic), std::begin(file_buffer));
+
+	mz_ulong compressed_size = std::size(file_buffer) - sizeof(boot_state_magic);
+
+	if (mz_compress2(&file_buffer[sizeof(boot_state_magic)], &compressed_size, reinterpret_cast<const unsigned char*>(&*state), sizeof(*state), MZ_BEST_SPEED) == MZ_OK)
+	{
+		file_buffer.resize(sizeof(boot_state_magic) + compressed_size);
+
+		std::error_code error;
+		std::filesystem::create_directories(boot_state_capture->path.parent_path(), error);
+
+		// Written in the background, so that the game does not stutter as it starts.
+		boot_state_writer.Write(boot_state_capture->path, std::move(file_buffer));
+	}
+
+	boot_state_capture.reset();
+}
+
 using SaveStateMagic = std::array<char, 8>;
 static const SaveStateMagic save_state_magic = {"CMDEFSS"}; // Clownacy Mega Drive Emulator Frontend Save State
 
@@ -117,6 +372,11 @@ bool EmulatorInstance::LoadSaveStateFile(SDL::IOStream &file)
 		return false;
 
 	reinterpret_cast<const StateBackup*>(&(*file_buffer)[sizeof(SaveStateMagic)])->Apply(*this);
+
+	// The loaded state is not a fresh boot.
+	boot_state_lookup_pending = false;
+	boot_state_capture.reset();
+
 	return true;
 }
 
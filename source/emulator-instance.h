@@ -3,15 +3,22 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
+#include <future>
+#include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "../common/core/source/clownmdemu.h"
 
 #include "colour.h"
+#include "disc-preloader.h"
 #include "emulator-extended.h"
+#include "hash.h"
+#include "save-data-writer.h"
 #include "sdl-wrapper.h"
 
 class EmulatorInstance final : public EmulatorExtended<EmulatorInstance, Colour>
@@ -30,7 +37,32 @@ private:
 	const FramerateCallback framerate_callback;
 
 	std::vector<cc_u16l> rom_file_buffer;
-	SDL::IOStream cd_stream;
+	std::unique_ptr<DiscPreloader> cd_stream;
+	// Hashing is done on another thread so that it does not delay loading.
+	// This must be declared after 'rom_file_buffer', so that it is destroyed (and waited on) before it.
+	std::shared_future<std::optional<Hash::Digests>> cartridge_digests;
+	// Discs are identified by the software loader, before they are inserted.
+	std::optional<Hash::Digests> cd_digests;
+	std::uintmax_t cd_image_size = 0;
+
+	// Mega CD games are snapshotted once they take control from the boot code, so that later boots can skip straight to that point.
+	struct BootStateCapture
+	{
+		Hash::SHA1::Digest disc_sha1;
+		std::uintmax_t disc_image_size;
+		std::filesystem::path path;
+		unsigned int frames_waited;
+	};
+
+	bool boot_state_cache_enabled = true;
+	// The cache is looked up just before the first frame that the disc is in the console for.
+	bool boot_state_lookup_pending = false;
+	std::optional<BootStateCapture> boot_state_capture;
+	SaveDataWriter boot_state_writer;
+
+	bool turbo_loading_enabled = false;
+	bool turbo_loading = false;
+	bool input_pressed = false;
 
 	SDL::Pixel *framebuffer_texture_pixels = nullptr;
 	int framebuffer_texture_pitch = 0;
@@ -39,17 +71,35 @@ private:
 	unsigned int current_screen_height = 0;
 	unsigned int current_widescreen_tiles = 0;
 
+	std::filesystem::path GetBootStatePath(const Hash::SHA1::Digest &disc_sha1, std::uintmax_t disc_image_size) const;
+	bool RestoreBootState(const std::filesystem::path &path);
+	void UpdateBootStateLookup();
+	void UpdateBootStateCapture();
+
 	void ScanlineRendered(cc_u16f scanline, const cc_u8l *pixels, cc_u16f left_boundary, cc_u16f right_boundary, cc_u16f screen_width, cc_u16f screen_height);
 	cc_bool InputRequested(cc_u8f player_id, ClownMDEmu_Button button_id);
 
 public:
 	EmulatorInstance(SDL::Texture &texture, const InputCallback &input_callback, const TitleCallback &title_callback, const FramerateCallback &framerate_callback);
 
-	void Update();
+	// When 'single_step' is true, such as when advancing a paused emulator by a frame, exactly one frame is run.
+	void Update(bool single_step = false);
 	void LoadCartridgeFile(std::vector<cc_u16l> &&file_buffer, const std::filesystem::path &path);
 	void UnloadCartridgeFile();
-	bool LoadCDFile(SDL::IOStream &&stream, const std::filesystem::path &path);
+	// 'reader' must already be open on 'stream'. 'digests' and 'image_size' are from 'CDReader::HashDataTrack' and 'CDReader::GetImageSize'.
+	bool LoadCDFile(std::unique_ptr<DiscPreloader> &&stream, std::unique_ptr<CDReader> &&reader, const std::filesystem::path &path, const std::optional<Hash::Digests> &digests, std::uintmax_t image_size);
 	void UnloadCDFile();
+	std::optional<float> GetCDPreloadProgress() const;
+	// This returns nothing until hashing has finished.
+	std::optional<Hash::Digests> GetCartridgeDigests() const;
+	std::optional<Hash::Digests> GetCDDigests() const;
+
+	void SetBootStateCacheEnabled(const bool enabled) { boot_state_cache_enabled = enabled; }
+	bool GetBootStateCacheEnabled() const { return boot_state_cache_enabled; }
+
+	void SetTurboLoadingEnabled(const bool enabled) { turbo_loading_enabled = enabled; }
+	bool GetTurboLoadingEnabled() const { return turbo_loading_enabled; }
+	bool IsTurboLoading() const { return turbo_loading; }
 
 	bool ValidateSaveStateFile(SDL::IOStream &file) const;
 	bool ValidateSaveStateFile(const std::filesystem::path &path) const;
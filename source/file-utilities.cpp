@@ -1,7 +1,12 @@
 #include "file-utilities.h"
 
+#include <algorithm>
+#include <cctype>
 #include <climits>
 #include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #ifdef __EMSCRIPTEN__
@@ -278,59 +283,133 @@ void FileUtilities::SaveFile([[maybe_unused]] Window &window, [[maybe_unused]] c
 #endif
 }
 
-std::optional<std::vector<cc_u16l>> FileUtilities::LoadZIPFileToBuffer(SDL::IOStream &file, const unsigned int file_index)
+void FileUtilities::BytesToWords(const unsigned char* const bytes, const std::size_t total_bytes, cc_u16l* const words)
 {
-	const auto starting_position = SDL_TellIO(file);
+	// This is kept simple so that the compiler can vectorise it.
+	const auto total_whole_words = total_bytes / 2;
 
-	std::optional<std::vector<cc_u16l>> file_buffer;
+	for (std::size_t i = 0; i < total_whole_words; ++i)
+		words[i] = static_cast<cc_u16l>(bytes[i * 2 + 0] << 8 | bytes[i * 2 + 1]);
 
-	mz_zip_archive miniz;
-	mz_zip_zero_struct(&miniz);
-	miniz.m_pRead = [](void* const pOpaque, const mz_uint64 file_ofs, void* const pBuf, const std::size_t n) -> std::size_t
-	{
-		SDL::IOStream &file = *static_cast<SDL::IOStream*>(pOpaque);
+	// Pad the final byte of odd-sized data.
+	if (total_bytes % 2 != 0)
+		words[total_whole_words] = static_cast<cc_u16l>(bytes[total_bytes - 1] << 8);
+}
 
-		SDL_SeekIO(file, file_ofs, SDL_IO_SEEK_SET);
-		return SDL_ReadIO(file, pBuf, n);
-	};
-	miniz.m_pIO_opaque = &file;
+std::optional<std::vector<cc_u16l>> FileUtilities::LoadZIPFileToBuffer(SDL::IOStream &file)
+{
+	const auto starting_position = SDL_TellIO(file);
 
-	if (mz_zip_reader_init(&miniz, SDL_GetIOSize(file), 0))
+	const auto &LoadZIP = [&]() -> std::optional<std::vector<cc_u16l>>
 	{
-		if (mz_zip_validate_file(&miniz, file_index, MZ_ZIP_FLAG_VALIDATE_HEADERS_ONLY))
+		// Check for the local file header signature before reading the whole file.
+		static constexpr std::array<unsigned char, 4> signature = {'P', 'K', 3, 4};
+		std::array<unsigned char, std::size(signature)> file_signature;
+
+		if (SDL_SeekIO(file, 0, SDL_IO_SEEK_SET) == -1 || SDL_ReadIO(file, std::data(file_signature), std::size(file_signature)) != std::size(file_signature) || file_signature != signature)
+			return std::nullopt;
+
+		// Read the whole archive into memory at once, rather than letting miniz seek and read for each of its accesses.
+		const auto archive_size = SDL_GetIOSize(file);
+
+		if (archive_size < 0 || SDL_SeekIO(file, 0, SDL_IO_SEEK_SET) == -1)
+			return std::nullopt;
+
+		std::vector<unsigned char> archive;
+
+		try
+		{
+			archive.resize(static_cast<std::size_t>(archive_size));
+		}
+		catch (const std::bad_alloc&)
 		{
-			file_buffer.emplace();
+			return std::nullopt;
+		}
 
-			if (!mz_zip_reader_extract_to_callback(
-				&miniz, file_index,
-				[](void* const pOpaque, const mz_uint64 file_ofs, const void* const pBuf, const std::size_t n) -> std::size_t
-				{
-					auto &file_buffer = *static_cast<std::vector<cc_u16l>*>(pOpaque);
-					auto bytes = static_cast<const unsigned char*>(pBuf);
+		if (SDL_ReadIO(file, std::data(archive), std::size(archive)) != std::size(archive))
+			return std::nullopt;
 
-					const auto end = (file_ofs + n + 1) / 2;
-					if (file_buffer.size() < end)
-						file_buffer.resize(end);
+		mz_zip_archive miniz;
+		mz_zip_zero_struct(&miniz);
 
-					for (std::size_t i = 0; i < n; ++i)
-					{
-						const auto byte_position = file_ofs + i;
-						const bool upper_byte = byte_position % 2 == 0;
-						const unsigned int shift = upper_byte ? 8 : 0;
-						auto &value = file_buffer[byte_position / 2];
+		if (!mz_zip_reader_init_mem(&miniz, std::data(archive), std::size(archive), 0))
+			return std::nullopt;
 
-						value &= ~(0xFFu << shift);
-						value |= bytes[i] << shift;
-					}
+		// Archives may contain read-me files and the like, so pick the file that looks most like a ROM:
+		// prefer ones with a cartridge file extension, and then the largest.
+		std::optional<mz_zip_archive_file_stat> chosen_file;
+		bool chosen_file_has_rom_extension = false;
+
+		for (mz_uint i = 0; i < mz_zip_reader_get_num_files(&miniz); ++i)
+		{
+			mz_zip_archive_file_stat stat;
+
+			if (!mz_zip_reader_file_stat(&miniz, i, &stat) || stat.m_is_directory || stat.m_is_encrypted || !stat.m_is_supported)
+				continue;
+
+			const std::string_view filename(stat.m_filename);
+			const auto extension_position = filename.find_last_of('.');
+			std::string extension(extension_position == std::string_view::npos ? std::string_view() : filename.substr(extension_position));
+			std::transform(std::begin(extension), std::end(extension), std::begin(extension), [](const unsigned char character) { return std::tolower(character); });
+			const bool has_rom_extension = extension == ".bin" || extension == ".md" || extension == ".gen";
+
+			const auto &IsBetterThanChosenFile = [&]()
+			{
+				if (!chosen_file.has_value())
+					return true;
+
+				if (has_rom_extension != chosen_file_has_rom_extension)
+					return has_rom_extension;
+
+				return stat.m_uncomp_size > chosen_file->m_uncomp_size;
+			};
+
+			if (IsBetterThanChosenFile())
+			{
+				chosen_file = stat;
+				chosen_file_has_rom_extension = has_rom_extension;
+			}
+		}
+
+		std::optional<std::vector<cc_u16l>> file_buffer;
+
+		if (chosen_file.has_value())
+		{
+			try
+			{
+				// Inflate the whole file in one go, now that its size is known, and then convert it to words in one go.
+				const auto file_size = static_cast<std::size_t>(chosen_file->m_uncomp_size);
+				std::vector<unsigned char> bytes(file_size);
 
-					return n;
-				},
-				&*file_buffer, 0
-			))
-				file_buffer = std::nullopt;
+				if (mz_zip_reader_extract_to_mem(&miniz, chosen_file->m_file_index, std::data(bytes), std::size(bytes), 0))
+				{
+					file_buffer.emplace(CC_DIVIDE_CEILING(file_size, 2));
+					BytesToWords(std::data(bytes), std::size(bytes), std::data(*file_buffer));
+				}
+			}
+			catch (const std::bad_alloc&)
+			{
+				// This is called from worker threads, where the debug log cannot be used, so leave it to the caller to report.
+				mz_zip_reader_end(&miniz);
+				throw;
+			}
 		}
 
 		mz_zip_reader_end(&miniz);
+
+		return file_buffer;
+	};
+
+	std::optional<std::vector<cc_u16l>> file_buffer;
+
+	try
+	{
+		file_buffer = LoadZIP();
+	}
+	catch (const std::bad_alloc&)
+	{
+		SDL_SeekIO(file, starting_position, SDL_IO_SEEK_SET);
+		throw;
 	}
 
 	SDL_SeekIO(file, starting_position, SDL_IO_SEEK_SET);
@@ -338,13 +417,15 @@ std::optional<std::vector<cc_u16l>> FileUtilities::LoadZIPFileToBuffer(SDL::IOSt
 	return file_buffer;
 }
 
-std::optional<std::vector<unsigned char>> FileUtilities::DecompressLZMABuffer(const unsigned char* const input_buffer, const std::size_t input_buffer_size, const std::size_t uncompressed_size)
+std::optional<std::vector<unsigned char>> FileUtilities::DecompressLZMABuffer(const unsigned char* const input_buffer, const std::size_t input_buffer_size, const std::size_t uncompressed_size, const DecompressionProgressCallback &progress_callback)
 {
+	constexpr unsigned int header_size = LZMA_PROPS_SIZE + 8;
+
+	if (input_buffer_size < header_size)
+		return std::nullopt;
+
 	std::optional<std::vector<unsigned char>> decompressed_buffer(uncompressed_size);
 
-	SizeT output_written = std::size(*decompressed_buffer), input_read = input_buffer_size;
-	constexpr unsigned int header_size = 13;
-	ELzmaStatus status;
 	static constexpr ISzAlloc allocation = {
 		[]([[maybe_unused]] const ISzAllocPtr p, const std::size_t size)
 		{
@@ -355,10 +436,56 @@ std::optional<std::vector<unsigned char>> FileUtilities::DecompressLZMABuffer(co
 			std::free(address);
 		}
 	};
-	const auto result = LzmaDecode(std::data(*decompressed_buffer), &output_written, input_buffer + header_size, &input_read, input_buffer, header_size, LZMA_FINISH_END, &status, &allocation);
 
-	if (result != SZ_OK)
-		decompressed_buffer = std::nullopt;
+	// This is 'LzmaDecode', but split into chunks so that the caller can stop it early.
+	// The output buffer doubles as the dictionary, so nothing is copied.
+	CLzmaDec state;
+	LzmaDec_Construct(&state);
+
+	if (LzmaDec_AllocateProbs(&state, input_buffer, LZMA_PROPS_SIZE, &allocation) != SZ_OK)
+		return std::nullopt;
+
+	state.dic = std::data(*decompressed_buffer);
+	state.dicBufSize = std::size(*decompressed_buffer);
+	LzmaDec_Init(&state);
+
+	// Without a callback, there's no reason to stop early, so do it all in one go.
+	const std::size_t chunk_size = progress_callback == nullptr ? uncompressed_size : 0x40000;
+	std::size_t input_position = header_size;
+
+	for (;;)
+	{
+		const auto previous_output_position = state.dicPos;
+		const auto output_limit = std::min(uncompressed_size, state.dicPos + chunk_size);
+		SizeT input_read = input_buffer_size - input_position;
+		ELzmaStatus status;
+
+		if (LzmaDec_DecodeToDic(&state, output_limit, input_buffer + input_position, &input_read, LZMA_FINISH_ANY, &status) != SZ_OK)
+		{
+			decompressed_buffer = std::nullopt;
+			break;
+		}
+
+		input_position += input_read;
+
+		if (state.dicPos == uncompressed_size)
+			break;
+
+		// Bail if the stream ended before the output was filled.
+		if (input_read == 0 && state.dicPos == previous_output_position)
+		{
+			decompressed_buffer = std::nullopt;
+			break;
+		}
+
+		if (progress_callback != nullptr && progress_callback(std::data(*decompressed_buffer), state.dicPos))
+		{
+			decompressed_buffer->resize(state.dicPos);
+			break;
+		}
+	}
+
+	LzmaDec_FreeProbs(&state, &allocation);
 
 	return decompressed_buffer;
 }
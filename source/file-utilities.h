@@ -21,6 +21,8 @@ class FileUtilities
 {
 public:
 	using SaveFileInnerCallback = std::function<bool(const void *data, std::size_t data_size)>;
+	// Called as decompression progresses with everything decompressed so far. Return 'true' to stop early.
+	using DecompressionProgressCallback = std::function<bool(const unsigned char *data, std::size_t data_size)>;
 	using Filters = tcb::span<const SDL_DialogFileFilter>;
 
 private:
@@ -120,8 +122,10 @@ public:
 		return LoadFileToBuffer<T, S>(file);
 	}
 
-	static std::optional<std::vector<cc_u16l>> LoadZIPFileToBuffer(SDL::IOStream &file, unsigned int file_index);
-	static std::optional<std::vector<unsigned char>> DecompressLZMABuffer(const unsigned char *buffer, std::size_t buffer_size, std::size_t uncompressed_size);
+	static void BytesToWords(const unsigned char *bytes, std::size_t total_bytes, cc_u16l *words);
+	// Returns nothing if the file is not a ZIP file. Throws 'std::bad_alloc' if it is one, but its ROM is too large to load.
+	static std::optional<std::vector<cc_u16l>> LoadZIPFileToBuffer(SDL::IOStream &file);
+	static std::optional<std::vector<unsigned char>> DecompressLZMABuffer(const unsigned char *buffer, std::size_t buffer_size, std::size_t uncompressed_size, const DecompressionProgressCallback &progress_callback = nullptr);
 
 	void LoadFile(Window &window, const char *title, const char *default_filename, const Filters &filters, LoadFileCallback callback);
 	void SaveFile(Window &window, const char *title, const char *default_filename, const Filters &filters, SaveFileCallback callback);
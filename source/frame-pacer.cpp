@@ -0,0 +1,294 @@
+#include "frame-pacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+
+// If the display was not suitable, then check again after this long, in case the display mode has changed.
+static constexpr Uint64 probe_retry_delay = SDL_NS_PER_SECOND * 10;
+
+// Spare time that is left on top of the slowest recent frames, to cover presenting and the OS waking the thread up late.
+// It grows whenever a refresh is missed, and shrinks again after a while without any being missed.
+static constexpr Uint64 minimum_frame_delay_margin = SDL_NS_PER_MS;
+static constexpr Uint64 initial_frame_delay_margin = SDL_NS_PER_MS * 2;
+static constexpr Uint64 frame_delay_margin_step = SDL_NS_PER_MS / 4;
+static constexpr unsigned int frame_delay_margin_shrink_frames = 120;
+
+static Uint64 Difference(const Uint64 a, const Uint64 b)
+{
+	return a > b ? a - b : b - a;
+}
+
+////////////////
+// Statistics //
+////////////////
+
+void FramePacer::Statistics::Add(const double sample)
+{
+	samples[samples_index] = sample;
+	samples_index = (samples_index + 1) % std::size(samples);
+	total_samples = std::min(total_samples + 1, std::size(samples));
+}
+
+double FramePacer::Statistics::GetMean() const
+{
+	if (IsEmpty())
+		return 0.0;
+
+	return std::accumulate(std::begin(samples), std::begin(samples) + total_samples, 0.0) / total_samples;
+}
+
+double FramePacer::Statistics::GetStandardDeviation() const
+{
+	if (IsEmpty())
+		return 0.0;
+
+	const double mean = GetMean();
+
+	return std::sqrt(std::accumulate(std::begin(samples), std::begin(samples) + total_samples, 0.0,
+		[&](const double total, const double sample)
+		{
+			return total + (sample - mean) * (sample - mean);
+		}
+	) / total_samples);
+}
+
+/////////////////
+// Frame Pacer //
+/////////////////
+
+FramePacer::FramePacer()
+	: frame_delay_margin(initial_frame_delay_margin)
+{}
+
+void FramePacer::StartProbe()
+{
+	state = State::PROBING;
+	intervals_index = 0;
+	last_frame_time = 0;
+}
+
+void FramePacer::SwitchToTimer(const Uint64 current_time)
+{
+	state = State::TIMER;
+	next_frame_time = current_time;
+	next_probe_time = current_time + probe_retry_delay;
+}
+
+bool FramePacer::ShouldProbe(SDL_Window* const window) const
+{
+	// Probing runs a frame for every refresh, so avoid doing it on displays which are obviously too fast or too slow.
+	// The reported refresh rate is only used as a hint, as it is often rounded or just wrong.
+	// Hidden windows often are not V-synced at all, so they are not worth probing either.
+	if ((SDL_GetWindowFlags(window) & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED | SDL_WINDOW_OCCLUDED)) != 0)
+		return false;
+
+	const SDL_DisplayID display_index = SDL_GetDisplayForWindow(window);
+
+	if (display_index == 0)
+		return true;
+
+	const SDL_DisplayMode* const display_mode = SDL_GetCurrentDisplayMode(display_index);
+
+	if (display_mode == nullptr || display_mode->refresh_rate == 0.0f)
+		return true;
+
+	const double nominal_interval = SDL_NS_PER_SECOND / display_mode->refresh_rate;
+
+	return std::abs(nominal_interval - frame_duration) <= frame_duration / 20.0;
+}
+
+bool FramePacer::ShouldRunFrameForAudio(const Uint64 current_time, const Uint32 audio_queued_frames, const Uint32 audio_target_frames)
+{
+	// The audio device consumes audio in batches, so several frames may be needed at once to refill it,
+	// but do not let a stalled or missing audio device make the emulator run at an unlimited speed.
+	const Uint64 minimum_time = last_frame_start_time + frame_duration / 2;
+	// If the audio device is not consuming audio, such as while the emulator is paused, then keep frames coming anyway.
+	const Uint64 maximum_time = last_frame_start_time + frame_duration * 2;
+
+	return current_time >= maximum_time || (audio_queued_frames < audio_target_frames && current_time >= minimum_time);
+}
+
+bool FramePacer::ShouldRunFrameForTimer(const Uint64 current_time)
+{
+	if (current_time < next_frame_time)
+		return false;
+
+	// If massively delayed, resynchronise to avoid fast-forwarding.
+	if (current_time >= next_frame_time + SDL_NS_PER_SECOND / 10)
+		next_frame_time = current_time;
+
+	next_frame_time += frame_duration;
+
+	return true;
+}
+
+bool FramePacer::ShouldRunFrame(const Uint64 current_time, const Uint64 frame_duration, const bool vsync, SDL_Window* const window, const bool audio_usable, const Uint32 audio_queued_frames, const Uint32 audio_target_frames)
+{
+	// Switching between NTSC and PAL makes the previous measurements meaningless.
+	if (this->frame_duration != frame_duration)
+	{
+		this->frame_duration = frame_duration;
+		Restart();
+	}
+
+	if (mode != Mode::DISPLAY || !vsync)
+	{
+		if (state != State::TIMER)
+			SwitchToTimer(current_time);
+
+		next_probe_time = 0;
+	}
+	else if (state == State::TIMER && current_time >= next_probe_time)
+	{
+		if (ShouldProbe(window))
+			StartProbe();
+		else
+			next_probe_time = current_time + probe_retry_delay;
+	}
+
+	const bool use_audio = mode == Mode::AUDIO && audio_usable;
+
+	// Start the timer afresh when falling back to it, rather than letting it catch up on the frames that audio ran.
+	if (audio_active && !use_audio)
+		next_frame_time = current_time;
+
+	audio_active = use_audio;
+
+	bool run_frame;
+
+	if (audio_active)
+		run_frame = ShouldRunFrameForAudio(current_time, audio_queued_frames, audio_target_frames);
+	else if (state != State::TIMER)
+		run_frame = !IsFrameDelayActive() || current_time >= frame_delay_deadline; // V-sync blocks until the next refresh, so that paces the frames on its own.
+	else
+		run_frame = ShouldRunFrameForTimer(current_time);
+
+	// Frames run while probing are paced by the display without being synchronised to it yet, so leave them out.
+	if (run_frame && state != State::PROBING)
+	{
+		auto &active_metrics = metrics[static_cast<std::size_t>(GetActiveMode())];
+
+		if (last_frame_start_time != 0)
+			active_metrics.frame_interval.Add(static_cast<double>(current_time - last_frame_start_time) / SDL_NS_PER_MS);
+
+		active_metrics.audio_queue_depth.Add(audio_queued_frames);
+
+	}
+
+	if (run_frame)
+		last_frame_start_time = current_time;
+
+	return run_frame;
+}
+
+void FramePacer::UpdateFrameDelay(const Uint64 current_time, const Uint64 interval)
+{
+	// A frame which took much longer than a refresh to be presented must have missed one.
+	if (interval > measured_interval * 3 / 2)
+	{
+		++missed_refreshes;
+		frames_since_missed_refresh = 0;
+		frame_delay_margin = std::min(frame_delay_margin + frame_delay_margin_step * 4, measured_interval / 2);
+	}
+	else if (++frames_since_missed_refresh == frame_delay_margin_shrink_frames)
+	{
+		frames_since_missed_refresh = 0;
+		frame_delay_margin = std::max(frame_delay_margin - std::min(frame_delay_margin, frame_delay_margin_step), minimum_frame_delay_margin);
+	}
+
+	const Uint64 frame_budget = frame_cost_p99 + frame_delay_margin;
+	frame_delay = frame_budget < measured_interval ? measured_interval - frame_budget : 0;
+	frame_delay_deadline = current_time + frame_delay;
+	frame_delay_statistics.Add(static_cast<double>(frame_delay) / SDL_NS_PER_MS);
+}
+
+void FramePacer::FrameWorkFinished(const Uint64 cost, const bool can_delay)
+{
+	frame_delay_suspended = !can_delay;
+
+	if (frame_delay_suspended)
+		return;
+
+	frame_costs[frame_costs_index] = cost;
+	frame_costs_index = (frame_costs_index + 1) % std::size(frame_costs);
+	total_frame_costs = std::min(total_frame_costs + 1, std::size(frame_costs));
+
+	auto sorted_frame_costs = frame_costs;
+	const auto p99 = std::begin(sorted_frame_costs) + total_frame_costs * 99 / 100;
+	std::nth_element(std::begin(sorted_frame_costs), p99, std::begin(sorted_frame_costs) + total_frame_costs);
+	frame_cost_p99 = *p99;
+}
+
+void FramePacer::FrameFinished(const Uint64 current_time)
+{
+	if (state == State::TIMER)
+		return;
+
+	if (last_frame_time != 0)
+	{
+		const Uint64 interval = current_time - last_frame_time;
+
+		if (IsFrameDelayActive())
+			UpdateFrameDelay(current_time, interval);
+
+		intervals[intervals_index++] = interval;
+
+		if (intervals_index == std::size(intervals))
+		{
+			intervals_index = 0;
+
+			// Use the median, so that the occasional stutter does not throw the measurement off.
+			auto sorted_intervals = intervals;
+			const auto middle = std::begin(sorted_intervals) + std::size(sorted_intervals) / 2;
+			std::nth_element(std::begin(sorted_intervals), middle, std::end(sorted_intervals));
+			measured_interval = *middle;
+
+			// The dynamic rate control can only absorb a small difference in speed before the audio audibly changes pitch.
+			if (Difference(measured_interval, frame_duration) <= frame_duration / 100)
+				state = State::DISPLAY;
+			else
+				SwitchToTimer(current_time);
+		}
+	}
+
+	last_frame_time = current_time;
+}
+
+void FramePacer::Restart()
+{
+	if (state == State::TIMER)
+		next_probe_time = 0;
+	else
+		StartProbe();
+}
+
+std::optional<double> FramePacer::GetMeasuredRefreshRate() const
+{
+	if (measured_interval == 0)
+		return std::nullopt;
+
+	return static_cast<double>(SDL_NS_PER_SECOND) / measured_interval;
+}
+
+FramePacer::Mode FramePacer::GetActiveMode() const
+{
+	if (audio_active)
+		return Mode::AUDIO;
+
+	// Probing is not counted as being synchronised yet.
+	return state == State::DISPLAY ? Mode::DISPLAY : Mode::TIMER;
+}
+
+void FramePacer::ClearMetrics()
+{
+	for (auto &mode_metrics : metrics)
+	{
+		mode_metrics.frame_interval.Clear();
+		mode_metrics.audio_queue_depth.Clear();
+	}
+
+	frame_delay_statistics.Clear();
+	missed_refreshes = 0;
+}
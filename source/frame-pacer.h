@@ -0,0 +1,122 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+#include <SDL3/SDL.h>
+
+// Decides when the emulator should run a frame.
+// When V-sync is enabled and the display refreshes at almost the same rate as the emulated console,
+// frames are run once per refresh instead, which avoids judder. The audio's dynamic rate control
+// makes up for the small difference in speed.
+// While synchronised, the start of each frame can also be delayed until shortly before the next refresh, so that
+// input is read later and shown sooner. The delay is tuned from how long recent frames took to produce.
+class FramePacer
+{
+public:
+	enum class Mode
+	{
+		TIMER,
+		DISPLAY,
+		AUDIO
+	};
+
+	// Rolling statistics, so that the different modes can be compared.
+	class Statistics
+	{
+	private:
+		std::array<double, 0x100> samples;
+		std::size_t samples_index = 0;
+		std::size_t total_samples = 0;
+
+	public:
+		void Add(double sample);
+		void Clear() { samples_index = total_samples = 0; }
+		[[nodiscard]] bool IsEmpty() const { return total_samples == 0; }
+		[[nodiscard]] double GetMean() const;
+		[[nodiscard]] double GetStandardDeviation() const;
+	};
+
+	struct Metrics
+	{
+		Statistics frame_interval; // In milliseconds.
+		Statistics audio_queue_depth; // In audio frames.
+	};
+
+private:
+	enum class State
+	{
+		TIMER,
+		PROBING,
+		DISPLAY
+	};
+
+	// The display's refresh rate is measured from this many presented frames.
+	static constexpr std::size_t total_intervals = 32;
+
+	State state = State::TIMER;
+	Uint64 frame_duration = 0;
+	Uint64 next_frame_time = 0;
+	Uint64 next_probe_time = 0;
+	Uint64 last_frame_time = 0;
+	std::array<Uint64, total_intervals> intervals;
+	std::size_t intervals_index = 0;
+	Uint64 measured_interval = 0;
+	Uint64 last_frame_start_time = 0;
+	bool audio_active = false;
+	std::array<Metrics, 3> metrics;
+
+	std::array<Uint64, 0x80> frame_costs;
+	std::size_t frame_costs_index = 0;
+	std::size_t total_frame_costs = 0;
+	Uint64 frame_cost_p99 = 0;
+	Uint64 frame_delay_margin;
+	Uint64 frame_delay = 0;
+	Uint64 frame_delay_deadline = 0;
+	bool frame_delay_suspended = false;
+	unsigned int frames_since_missed_refresh = 0;
+	unsigned int missed_refreshes = 0;
+	Statistics frame_delay_statistics; // In milliseconds.
+
+	void StartProbe();
+	void SwitchToTimer(Uint64 current_time);
+	void UpdateFrameDelay(Uint64 current_time, Uint64 interval);
+	bool ShouldProbe(SDL_Window *window) const;
+	bool ShouldRunFrameForAudio(Uint64 current_time, Uint32 audio_queued_frames, Uint32 audio_target_frames);
+	bool ShouldRunFrameForTimer(Uint64 current_time);
+
+public:
+	Mode mode = Mode::DISPLAY;
+	bool frame_delay_enabled = false;
+
+	FramePacer();
+
+	// Call this as often as possible: it returns whether a frame should be run now.
+	// When 'audio_usable' is false, such as when there is no audio device, audio pacing falls back to the timer.
+	[[nodiscard]] bool ShouldRunFrame(Uint64 current_time, Uint64 frame_duration, bool vsync, SDL_Window *window, bool audio_usable, Uint32 audio_queued_frames, Uint32 audio_target_frames);
+	// Call this once a frame has been run and drawn, but before it is presented.
+	// If the frame did unusual amounts of work, then pass false for 'can_delay': its cost is ignored, and the frame delay is suspended.
+	void FrameWorkFinished(Uint64 cost, bool can_delay = true);
+	// Call this after a frame has been run and presented.
+	void FrameFinished(Uint64 current_time);
+	// Call this when the window moves to another display.
+	void Restart();
+
+	[[nodiscard]] bool IsDisplaySynced() const { return state == State::DISPLAY; }
+	[[nodiscard]] std::optional<double> GetMeasuredRefreshRate() const;
+	// The mode that is actually in use, which differs from the selected mode when falling back to the timer.
+	[[nodiscard]] Mode GetActiveMode() const;
+	[[nodiscard]] const Metrics& GetMetrics(const Mode mode) const { return metrics[static_cast<std::size_t>(mode)]; }
+	void ClearMetrics();
+
+	[[nodiscard]] bool IsFrameDelayActive() const { return frame_delay_enabled && !frame_delay_suspended && state == State::DISPLAY; }
+	[[nodiscard]] double GetFrameCostP99() const { return static_cast<double>(frame_cost_p99) / SDL_NS_PER_MS; }
+	[[nodiscard]] double GetFrameDelayMargin() const { return static_cast<double>(frame_delay_margin) / SDL_NS_PER_MS; }
+	[[nodiscard]] unsigned int GetMissedRefreshes() const { return missed_refreshes; }
+	// This is how much later input is read, and therefore how much sooner it is shown.
+	[[nodiscard]] const Statistics& GetFrameDelayStatistics() const { return frame_delay_statistics; }
+};
+
+#endif /* FRAME_PACER_H */
@@ -10,6 +10,7 @@
 #include <functional>
 #include <iterator>
 #include <list>
+#include <new>
 #include <optional>
 #include <sstream>
 #include <string>
@@ -32,6 +33,9 @@
 #include "emulator-instance.h"
 #include "file-utilities.h"
 #include "input.h"
+#include "library.h"
+#include "startup-report.h"
+#include "tar.h"
 #include "windows/about.h"
 #include "windows/cheats.h"
 #include "windows/debug-cdc.h"
@@ -48,6 +52,7 @@
 #include "windows/debug-vdp.h"
 #include "windows/debug-z80.h"
 #include "windows/disassembler.h"
+#include "windows/library.h"
 #include "windows/common/window-with-framebuffer.h"
 
 #ifndef __EMSCRIPTEN__
@@ -79,6 +84,9 @@ struct RecentSoftware
 #endif
 
 static ScreenScaling screen_scaling;
+static bool preload_cd_files;
+static unsigned int autosave_interval; // In seconds.
+static Uint64 last_autosave_time;
 
 #ifndef NDEBUG
 static bool dear_imgui_demo_window;
@@ -241,6 +249,29 @@ private:
 		if (ComboWithToolTips("##Scaling", scaling_int, std::data(scaling_types), std::size(scaling_types)))
 			screen_scaling = static_cast<ScreenScaling>(scaling_int);
 
+	#ifndef __EMSCRIPTEN__
+		static const std::array<ComboItemAndToolTip, 3> frame_pacing_modes = {{
+			{
+				"Timer",
+				"Runs frames at exactly the console's speed.\nMay judder if the display's refresh rate differs."
+			},
+			{
+				"Display",
+				"Runs one frame per display refresh when V-sync is\nenabled and the refresh rate is close enough to the\nconsole's. Otherwise, falls back to the timer."
+			},
+			{
+				"Audio",
+				"Runs frames whenever the audio device needs more\naudio. This keeps the audio buffer small and steady,\nbut frames may be shown unevenly. Works best with\nV-sync disabled."
+			},
+		}};
+
+		DO_FORM_LAYOUT("Frame Pacing", "How to decide when to run frames.");
+
+		auto frame_pacing_int = static_cast<int>(frontend->frame_pacer.mode);
+		if (ComboWithToolTips("##Frame Pacing", frame_pacing_int, std::data(frame_pacing_modes), std::size(frame_pacing_modes)))
+			frontend->frame_pacer.mode = static_cast<FramePacer::Mode>(frame_pacing_int);
+	#endif
+
 		DO_FORM_LAYOUT(
 			"Widescreen Hack",
 			"Widens the display. Works well\n"
@@ -266,6 +297,16 @@ private:
 				"Makes games that use Interlace Mode 2\n"
 				"for split-screen not appear squashed.");
 
+		#ifndef __EMSCRIPTEN__
+			ImGui::TableNextColumn();
+			ImGui::Checkbox("Frame Delay", &frontend->frame_pacer.frame_delay_enabled);
+			DoToolTip(
+				"Waits until just before the display refreshes\n"
+				"to run each frame, which reduces input lag.\n"
+				"The wait is tuned automatically. Only works\n"
+				"when frames are synchronised to the display.");
+		#endif
+
 			ImGui::EndTable();
 		}
 
@@ -312,9 +353,84 @@ private:
 				"of RAM and increases CPU usage, so disable\n"
 				"this if there is lag.");
 
+			ImGui::TableNextColumn();
+			bool boot_state_cache_enabled = frontend->emulator->GetBootStateCacheEnabled();
+			if (ImGui::Checkbox("Mega CD Boot Cache", &boot_state_cache_enabled))
+				frontend->emulator->SetBootStateCacheEnabled(boot_state_cache_enabled);
+			DoToolTip(
+				"Saves the console's state once a disc has\n"
+				"finished booting, so that loading the disc\n"
+				"again skips straight to the game.");
+
+			ImGui::TableNextColumn();
+			bool turbo_loading_enabled = frontend->emulator->GetTurboLoadingEnabled();
+			if (ImGui::Checkbox("Turbo Loading", &turbo_loading_enabled))
+				frontend->emulator->SetTurboLoadingEnabled(turbo_loading_enabled);
+			DoToolTip(
+				"Runs Mega CD games as fast as possible while\n"
+				"they are reading from the disc. Audio is muted\n"
+				"while this happens, and normal speed resumes\n"
+				"as soon as a button is pressed.");
+
+		#ifndef __EMSCRIPTEN__
+			ImGui::TableNextColumn();
+			ImGui::Checkbox("Preload CD Files", &preload_cd_files);
+			DoToolTip(
+				"Copies CD files into RAM in the background\n"
+				"after they are loaded, so that the disc is\n"
+				"not read from storage during gameplay.\n"
+				"This uses as much RAM as the file's size.");
+		#endif
+
 			ImGui::EndTable();
 		}
 
+	#ifndef __EMSCRIPTEN__
+		DO_FORM_LAYOUT(
+			"CHD Cache",
+			"How much RAM to use for decompressing CHD files\n"
+			"ahead of time. This avoids stuttering during\n"
+			"videos, but uses more CPU cores.");
+
+		int cd_hunk_cache_size = frontend->emulator->GetCDHunkCacheSize();
+		const std::string cd_hunk_cache_slider_text = cd_hunk_cache_size == 0 ? "Disabled" : fmt::format("{} MiB", cd_hunk_cache_size);
+		if (ImGui::SliderInt("##CHD Cache Slider", &cd_hunk_cache_size, 0, 256, cd_hunk_cache_slider_text.c_str(), ImGuiSliderFlags_AlwaysClamp))
+			frontend->emulator->SetCDHunkCacheSize(cd_hunk_cache_size);
+	#endif
+
+		DO_FORM_LAYOUT(
+			"Autosave",
+			"How often to write the cartridge's save data\n"
+			"to disk while playing, so that it is not lost\n"
+			"if the computer crashes. Nothing is written if\n"
+			"the save data has not changed.");
+
+		int autosave_interval_slider = autosave_interval;
+		const std::string autosave_slider_text = autosave_interval_slider == 0 ? "Disabled" : fmt::format("Every {} Seconds", autosave_interval_slider);
+		if (ImGui::SliderInt("##Autosave Slider", &autosave_interval_slider, 0, 300, autosave_slider_text.c_str(), ImGuiSliderFlags_AlwaysClamp))
+			autosave_interval = autosave_interval_slider;
+
+	#ifndef __EMSCRIPTEN__
+		DO_FORM_LAYOUT(
+			"Debug Refresh Rate",
+			"How often newly-opened debug windows are redrawn.\n"
+			"Lower rates use less CPU while the game runs.\n"
+			"Right-click a window to change its own rate.\n"
+			"Only affects native windows.");
+
+		static const std::array<ComboItemAndToolTip, 5> refresh_rate_names_and_tooltips = {{
+			{WindowPopupRefresh::rate_names[0], "Redraw every frame."},
+			{WindowPopupRefresh::rate_names[1], "Redraw 30 times per second."},
+			{WindowPopupRefresh::rate_names[2], "Redraw 10 times per second."},
+			{WindowPopupRefresh::rate_names[3], "Redraw once per second."},
+			{WindowPopupRefresh::rate_names[4], "Only redraw while the emulator is paused."},
+		}};
+
+		auto refresh_rate_int = static_cast<int>(WindowPopupRefresh::default_rate);
+		if (ComboWithToolTips("##Debug Refresh Rate", refresh_rate_int, std::data(refresh_rate_names_and_tooltips), std::size(refresh_rate_names_and_tooltips)))
+			WindowPopupRefresh::default_rate = static_cast<WindowPopupRefresh::Rate>(refresh_rate_int);
+	#endif
+
 	#ifndef NDEBUG
 		ImGui::SeparatorText("Development");
 
@@ -618,8 +734,10 @@ public:
 
 #ifdef FILE_PATH_SUPPORT
 static std::list<RecentSoftware> recent_software_list;
+static std::optional<Library> library;
 #endif
 static std::filesystem::path drag_and_drop_filename;
+static std::optional<SoftwareLoader> software_loader;
 
 static bool emulator_has_focus; // Used for deciding when to pass inputs to the emulator.
 static bool emulator_frame_advance;
@@ -627,6 +745,9 @@ static bool emulator_frame_advance;
 static std::optional<EmulatorInstance::StateBackup> quick_save_state;
 
 static std::optional<Cheats> cheats_window;
+#ifdef FILE_PATH_SUPPORT
+static std::optional<LibraryWindow> library_window;
+#endif
 static std::optional<DebugLogViewer> debug_log_window;
 static std::optional<DebugToggles> debugging_toggles_window;
 static std::optional<Disassembler> disassembler_window;
@@ -664,6 +785,9 @@ static std::optional<AboutWindow> about_window;
 
 static constexpr auto popup_windows = std::make_tuple(
 	&cheats_window,
+#ifdef FILE_PATH_SUPPORT
+	&library_window,
+#endif
 	&debug_log_window,
 	&debugging_toggles_window,
 	&disassembler_window,
@@ -829,7 +953,8 @@ static std::filesystem::path configuration_directory_path;
 
 bool Frontend::IsFileCD(const std::filesystem::path& path)
 {
-	return CDReader::IsDefinitelyACD(path);
+	const auto probe = SoftwareProbe::Probe(path);
+	return probe.has_value() && probe->descriptor.type == SoftwareProbe::Type::CD;
 }
 
 static std::filesystem::path GetDefaultConfigurationDirectoryPath()
@@ -891,12 +1016,19 @@ bool Frontend::LoadCartridgeFile(const std::filesystem::path &path, SDL::IOStrea
 	{
 		std::optional<std::vector<cc_u16l>> file_buffer;
 
-		// First try loading the file as a ZIP file.
-		file_buffer = FileUtilities::LoadZIPFileToBuffer(file, 0); // Assume that it's the first file in the archive.
+		try
+		{
+			// First try loading the file as a ZIP file.
+			file_buffer = FileUtilities::LoadZIPFileToBuffer(file);
 
-		// Failing that, just load it as a raw binary.
-		if (!file_buffer.has_value())
-			file_buffer = FileUtilities::LoadFileToBuffer<cc_u16l, 2>(file);
+			// Failing that, just load it as a raw binary.
+			if (!file_buffer.has_value())
+				file_buffer = FileUtilities::LoadFileToBuffer<cc_u16l, 2>(file);
+		}
+		catch (const std::bad_alloc&)
+		{
+			debug_log.Log("Could not allocate memory for file");
+		}
 
 		if (file_buffer.has_value())
 		{
@@ -916,42 +1048,82 @@ bool Frontend::LoadCartridgeFile(const std::filesystem::path &path)
 	return LoadCartridgeFile(path, file);
 }
 
-bool Frontend::LoadCDFile(const std::filesystem::path &path, SDL::IOStream &&file)
+bool Frontend::LoadCDFile(const std::filesystem::path &path, std::unique_ptr<DiscPreloader> &&stream, std::unique_ptr<CDReader> &&reader, const std::optional<Hash::Digests> &digests, const std::uintmax_t image_size)
 {
 #ifdef FILE_PATH_SUPPORT
 	AddToRecentSoftware(path, true, false);
 #endif
 
 	// Load the CD.
-	if (!emulator->LoadCDFile(std::move(file), path))
+	if (!emulator->LoadCDFile(std::move(stream), std::move(reader), path, digests, image_size))
 		return false;
 
 	return true;
 }
 
-bool Frontend::LoadCDFile(const std::filesystem::path &path)
+#ifdef FILE_PATH_SUPPORT
+void Frontend::LoadSoftwareFile(const bool is_cd_file, const std::filesystem::path &path)
 {
-	SDL::IOStream file(path, "rb");
+	StartLoadingSoftware(path, nullptr, is_cd_file ? SoftwareLoader::Type::CD : SoftwareLoader::Type::CARTRIDGE);
+}
+#endif
 
-	if (!file)
-	{
-		debug_log.Log("Could not load the CD file");
-		window->ShowErrorMessageBox("Failed to load the CD file.");
-		return false;
-	}
+void Frontend::StartLoadingSoftware(const std::filesystem::path &path, SDL::IOStream &&file, const SoftwareLoader::Type type)
+{
+	// Starting a new load cancels any that is already in progress.
+	software_loader.reset();
+	software_loader.emplace(path, std::move(file), type,
+		[this](SDL::IOStream &file)
+		{
+			return emulator->ValidateSaveStateFile(file);
+		}, preload_cd_files
+	);
+}
 
-	return LoadCDFile(path, std::move(file));
+bool Frontend::IsLoadingSoftware() const
+{
+	return software_loader.has_value();
 }
 
-#ifdef FILE_PATH_SUPPORT
-bool Frontend::LoadSoftwareFile(const bool is_cd_file, const std::filesystem::path &path)
+void Frontend::FinishLoadingSoftware()
 {
-	if (is_cd_file)
-		return LoadCDFile(path);
-	else
-		return LoadCartridgeFile(path);
+	if (!software_loader.has_value() || !software_loader->IsFinished())
+		return;
+
+	auto result = software_loader->TakeResult();
+	software_loader.reset();
+
+	// Software passed on the command line is loaded on the loader thread, so its start-up phase only ends here.
+	StartupReport::EndPhase("Software");
+
+	if (!result.has_value())
+	{
+		debug_log.Log("Could not load the software file");
+		window->ShowErrorMessageBox("Failed to load the software file.");
+		return;
+	}
+
+	switch (result->type)
+	{
+		case SoftwareLoader::Type::UNKNOWN:
+			break;
+
+		case SoftwareLoader::Type::CARTRIDGE:
+			LoadCartridgeFile(result->path, std::move(result->cartridge_buffer));
+			emulator->SetPaused(false);
+			break;
+
+		case SoftwareLoader::Type::CD:
+			if (LoadCDFile(result->path, std::move(result->cd_stream), std::move(result->cd_reader), result->cd_digests, result->cd_image_size))
+				emulator->SetPaused(false);
+			break;
+
+		case SoftwareLoader::Type::SAVE_STATE:
+			if (emulator_on)
+				LoadSaveState(result->file);
+			break;
+	}
 }
-#endif
 
 bool Frontend::LoadSaveState(SDL::IOStream &file)
 {
@@ -1068,6 +1240,8 @@ void Frontend::LoadConfiguration()
 #endif
 	bool vsync = false;
 	screen_scaling = ScreenScaling::FIT;
+	frame_pacer.mode = FramePacer::Mode::DISPLAY;
+	frame_pacer.frame_delay_enabled = false;
 	Input::Controller::layout = Input::Controller::Layout::FOUR_BUTTON;
 	tall_double_resolution_mode = false;
 	unsigned int widescreen_tiles = 0;
@@ -1077,6 +1251,12 @@ void Frontend::LoadConfiguration()
 	native_windows = true;
 #endif
 	bool rewinding = true;
+	bool boot_state_cache = true;
+	bool turbo_loading = false;
+	preload_cd_files = false;
+	autosave_interval = 30;
+	WindowPopupRefresh::default_rate = WindowPopupRefresh::Rate::LIVE;
+	unsigned int cd_hunk_cache_size = 64;
 	bool low_pass_filter = true;
 	bool cd_add_on = false;
 	ControllerManager_Protocol input_protocol = CONTROLLER_MANAGER_PROTOCOL_STANDARD;
@@ -1102,7 +1282,8 @@ void Frontend::LoadConfiguration()
 		else
 		{
 			// Enable V-sync on displays with an FPS of a multiple of 60.
-			// TODO: ...But what about PAL50?
+			// 50Hz displays are left alone: until the frame pacer has synchronised to one, the timer would
+			// be throttled by V-sync, making NTSC games run at 50/60 speed. PAL users can still enable it manually.
 			vsync = std::lround(display_mode->refresh_rate) % 60 == 0;
 		}
 	}
@@ -1151,6 +1332,10 @@ void Frontend::LoadConfiguration()
 					vsync = value_boolean;
 				else if (name == "screen-scaling")
 					screen_scaling = value_integer.has_value() ? static_cast<ScreenScaling>(*value_integer) : ScreenScaling::FIT;
+				else if (name == "frame-pacing")
+					frame_pacer.mode = value_integer.has_value() ? static_cast<FramePacer::Mode>(*value_integer) : FramePacer::Mode::DISPLAY;
+				else if (name == "frame-delay")
+					frame_pacer.frame_delay_enabled = value_boolean;
 				else if (name == "controller-layout")
 					Input::Controller::layout = value_integer.has_value() ? static_cast<Input::Controller::Layout>(*value_integer) : Input::Controller::Layout::FOUR_BUTTON;
 				else if (name == "tall-interlace-mode-2")
@@ -1163,6 +1348,22 @@ void Frontend::LoadConfiguration()
 			#endif
 				else if (name == "rewinding")
 					rewinding = value_boolean;
+				else if (name == "boot-state-cache")
+					boot_state_cache = value_boolean;
+				else if (name == "turbo-loading")
+					turbo_loading = value_boolean;
+			#ifndef __EMSCRIPTEN__
+				else if (name == "preload-cd-files")
+					preload_cd_files = value_boolean;
+				else if (name == "chd-cache-size")
+					cd_hunk_cache_size = value_integer.value_or(64);
+			#endif
+				else if (name == "autosave-interval")
+					autosave_interval = value_integer.value_or(30);
+			#ifndef __EMSCRIPTEN__
+				else if (name == "debug-refresh-rate")
+					WindowPopupRefresh::default_rate = static_cast<WindowPopupRefresh::Rate>(std::min<unsigned int>(value_integer.value_or(0), std::size(WindowPopupRefresh::rate_names) - 1));
+			#endif
 				else if (name == "low-pass-filter")
 					low_pass_filter = value_boolean;
 				else if (name == "cd-add-on")
@@ -1276,6 +1477,11 @@ void Frontend::LoadConfiguration()
 						AddToRecentSoftware(FileUtilities::U8Path(value), is_cd_file, true);
 				}
 			}
+			else if (section == "Library Directories")
+			{
+				if (name == "path" && !value.empty())
+					library->directories.push_back(FileUtilities::U8Path(value));
+			}
 		#endif
 			else if (section == "Window Positions")
 			{
@@ -1315,6 +1521,9 @@ void Frontend::LoadConfiguration()
 	window->SetVSync(vsync);
 	emulator->SetWidescreenTiles(widescreen_tiles);
 	emulator->SetRewindEnabled(rewinding);
+	emulator->SetBootStateCacheEnabled(boot_state_cache);
+	emulator->SetTurboLoadingEnabled(turbo_loading);
+	emulator->SetCDHunkCacheSize(cd_hunk_cache_size);
 	emulator->SetLowPassFilterEnabled(low_pass_filter);
 	emulator->SetCDAddOnEnabled(cd_add_on);
 	emulator->SetControllerProtocol(input_protocol);
@@ -1368,6 +1577,8 @@ void Frontend::SaveConfiguration()
 	#endif
 		PRINT_BOOLEAN_OPTION(file, "vsync", window->GetVSync());
 		PRINT_INTEGER_OPTION(file, "screen-scaling", static_cast<int>(screen_scaling));
+		PRINT_INTEGER_OPTION(file, "frame-pacing", static_cast<int>(frame_pacer.mode));
+		PRINT_BOOLEAN_OPTION(file, "frame-delay", frame_pacer.frame_delay_enabled);
 		PRINT_INTEGER_OPTION(file, "controller-layout", static_cast<int>(Input::Controller::layout));
 		PRINT_BOOLEAN_OPTION(file, "tall-interlace-mode-2", tall_double_resolution_mode);
 		PRINT_INTEGER_OPTION(file, "widescreen-tiles", emulator->GetWidescreenTiles());
@@ -1375,6 +1586,16 @@ void Frontend::SaveConfiguration()
 		PRINT_BOOLEAN_OPTION(file, "native-windows", native_windows);
 	#endif
 		PRINT_BOOLEAN_OPTION(file, "rewinding", emulator->GetRewindEnabled());
+		PRINT_BOOLEAN_OPTION(file, "boot-state-cache", emulator->GetBootStateCacheEnabled());
+		PRINT_BOOLEAN_OPTION(file, "turbo-loading", emulator->GetTurboLoadingEnabled());
+	#ifndef __EMSCRIPTEN__
+		PRINT_BOOLEAN_OPTION(file, "preload-cd-files", preload_cd_files);
+		PRINT_INTEGER_OPTION(file, "chd-cache-size", static_cast<int>(emulator->GetCDHunkCacheSize()));
+	#endif
+		PRINT_INTEGER_OPTION(file, "autosave-interval", static_cast<int>(autosave_interval));
+	#ifndef __EMSCRIPTEN__
+		PRINT_INTEGER_OPTION(file, "debug-refresh-rate", static_cast<int>(WindowPopupRefresh::default_rate));
+	#endif
 		PRINT_BOOLEAN_OPTION(file, "low-pass-filter", emulator->GetLowPassFilterEnabled());
 		PRINT_BOOLEAN_OPTION(file, "cd-add-on", emulator->GetCDAddOnEnabled());
 		PRINT_INTEGER_OPTION(file, "input-protocol", emulator->GetControllerProtocol());
@@ -1495,6 +1716,23 @@ void Frontend::SaveConfiguration()
 			);
 			PRINT_NEWLINE(file);
 		}
+
+		PRINT_NEWLINE(file);
+
+		// Save the directories that the library scans.
+		PRINT_HEADER(file, "Library Directories");
+
+		for (const auto &directory : library->directories)
+		{
+			PRINT_KEY(file, "path");
+			FileUtilities::PathToStringView(directory,
+				[&](const std::string_view &string_view)
+				{
+					SDL_WriteIO(file, std::data(string_view), std::size(string_view));
+				}
+			);
+			PRINT_NEWLINE(file);
+		}
 	#endif
 
 		PRINT_NEWLINE(file);
@@ -1547,6 +1785,32 @@ void Frontend::SaveConfiguration()
 // Main function //
 ///////////////////
 
+namespace CompressedGameControllerDB
+{
+	#include "../../assets/gamecontrollerdb/archive.tar.lzma.h"
+}
+
+static void LoadGamepadMappings()
+{
+	// Decompressing and parsing the whole database is slow, so it is only done once a joystick is actually attached.
+	// SDL re-checks attached joysticks when mappings are added, so any that become gamepads are still announced.
+	static bool loaded;
+
+	if (loaded)
+		return;
+
+	loaded = true;
+
+	static constexpr char mappings_path[] = "SDL_GameControllerDB/gamecontrollerdb.txt";
+	const auto archive = TarBall(CompressedGameControllerDB::buffer, CompressedGameControllerDB::uncompressed_size, TarBall::Compression::LZMA, mappings_path);
+	const auto mappings = archive.OpenFile(mappings_path);
+
+	if (!mappings.has_value())
+		debug_log.Log("Could not find the gamepad mappings database");
+	else if (SDL_AddGamepadMappingsFromIO(SDL::IOStream(std::data(*mappings), std::size(*mappings)), false) < 0)
+		debug_log.SDLError("SDL_AddGamepadMappingsFromIO");
+}
+
 void Frontend::PreEventStuff()
 {
 	emulator_on = emulator->IsCartridgeInserted() || emulator->IsCDInserted();
@@ -1561,8 +1825,13 @@ Frontend::Frontend(const EmulatorInstance::FramerateCallback &framerate_callback
 	IMGUI_CHECKVERSION();
 
 	InitialiseConfigurationDirectoryPath(user_data_path);
+#ifdef FILE_PATH_SUPPORT
+	library.emplace(GetConfigurationDirectoryPath() / "library-index.bin");
+#endif
 
 	window.emplace(DEFAULT_TITLE, INITIAL_WINDOW_WIDTH, INITIAL_WINDOW_HEIGHT, FRAMEBUFFER_WIDTH, FRAMEBUFFER_HEIGHT, true, std::nullopt, SDL_WINDOW_FILL_DOCUMENT);
+	StartupReport::EndPhase("Main window");
+
 	emulator.emplace(window->framebuffer_texture, ReadInputCallback,
 		[this](const std::string &title)
 		{
@@ -1572,6 +1841,7 @@ Frontend::Frontend(const EmulatorInstance::FramerateCallback &framerate_callback
 		},
 		framerate_callback
 	);
+	StartupReport::EndPhase("Emulator");
 
 	LoadConfiguration();
 
@@ -1581,6 +1851,7 @@ Frontend::Frontend(const EmulatorInstance::FramerateCallback &framerate_callback
 			ImGui::LoadIniSettingsFromDisk(string);
 		}
 	);
+	StartupReport::EndPhase("Configuration");
 
 	if (fullscreen)
 		window->SetFullscreen(true);
@@ -1604,7 +1875,9 @@ Frontend::Frontend(const EmulatorInstance::FramerateCallback &framerate_callback
 	if (!cartridge_path.empty())
 		LoadCartridgeFile(cartridge_path);
 	if (!cd_path.empty())
-		LoadCDFile(cd_path);
+		StartLoadingSoftware(cd_path, nullptr, SoftwareLoader::Type::CD);
+	else
+		StartupReport::EndPhase("Software");
 
 	// We are now ready to show the window
 	SDL_ShowWindow(window->GetSDLWindow());
@@ -1626,6 +1899,11 @@ Frontend::~Frontend()
 		}, popup_windows
 	);
 
+#ifdef FILE_PATH_SUPPORT
+	// Stop any scan before SDL is shut-down.
+	library.reset();
+#endif
+
 	WriteSaveData();
 }
 
@@ -1713,6 +1991,10 @@ void Frontend::HandleMainWindowEvent(const SDL_Event &event)
 
 			break;
 
+		case SDL_EVENT_JOYSTICK_ADDED:
+			LoadGamepadMappings();
+			break;
+
 		case SDL_EVENT_GAMEPAD_ADDED:
 		{
 			// Open the controller, and create an entry for it in the controller list.
@@ -1791,6 +2073,12 @@ void Frontend::HandleMainWindowEvent(const SDL_Event &event)
 			drag_and_drop_filename = FileUtilities::U8Path(event.drop.data);
 			break;
 
+		case SDL_EVENT_WINDOW_DISPLAY_CHANGED:
+		case SDL_EVENT_DISPLAY_CURRENT_MODE_CHANGED:
+			// The new display's refresh rate needs measuring.
+			frame_pacer.Restart();
+			break;
+
 		default:
 			break;
 	}
@@ -1859,7 +2147,9 @@ void Frontend::HandleEvent(const SDL_Event &event)
 
 void Frontend::DrawStatusIndicator(const ImVec2 &display_position, const ImVec2 &display_size)
 {
-	if (emulator->IsPaused() || emulator->rewinding || emulator->IsFastForwarding())
+	const auto &cd_preload_progress = emulator->GetCDPreloadProgress();
+
+	if (emulator->IsPaused() || emulator->rewinding || emulator->IsFastForwarding() || emulator->IsTurboLoading() || cd_preload_progress.has_value() || software_loader.has_value())
 	{
 		// A bunch of utility junk.
 		const auto DrawOutlinedTriangle = [](ImDrawList* const draw_list, const ImVec2 &position, const float radius, const float outline_thickness, const unsigned int degree)
@@ -1954,50 +2244,60 @@ void Frontend::DrawStatusIndicator(const ImVec2 &display_position, const ImVec2
 			if (emulator->IsRewindExhausted())
 				DrawCross(draw_list, position, ImVec2(radius, radius), outline_thickness);
 		}
-		else if (emulator->IsFastForwarding())
+		else if (emulator->IsFastForwarding() || emulator->IsTurboLoading())
 		{
 			// Fast-forwarding symbol.
 			const auto angle = 90;
 			DrawOutlinedTriangle(draw_list, right_position, radius, outline_thickness, angle);
 			DrawOutlinedTriangle(draw_list, left_position, radius, outline_thickness, angle);
 		}
+
+		// Show how much of the CD has been copied into RAM, at the bottom of the screen.
+		if (cd_preload_progress.has_value())
+			DrawBar(draw_list, display_position + ImVec2(display_size.x - radius * 2, display_size.y - radius * 3), radius, outline_thickness, *cd_preload_progress);
+
+		// Show how much of the software that is being loaded has been read, just above that.
+		if (software_loader.has_value())
+			DrawBar(draw_list, display_position + ImVec2(display_size.x - radius * 2, display_size.y - radius * 4), radius, outline_thickness, software_loader->GetProgress());
 	}
 }
 
 void Frontend::Update()
 {
+	const Uint64 update_start_time = SDL_GetTicksNS();
+
 	UpdateFastForwardStatus();
 	UpdateRewindStatus();
 
 	if (emulator_on && (!emulator->IsPaused() || emulator_frame_advance) && !file_utilities.IsDialogOpen() && (!emulator->rewinding || !emulator->IsRewindExhausted()))
 	{
-		emulator->Update();
+		// While paused, this is a frame advance, which must not be turned into many frames by turbo loading.
+		emulator->Update(emulator->IsPaused());
 		++frame_counter;
 	}
 
+	// Periodically back-up the cartridge's save data in case of a crash.
+	if (autosave_interval != 0 && SDL_GetTicks() - last_autosave_time >= autosave_interval * 1000ull)
+	{
+		last_autosave_time = SDL_GetTicks();
+		emulator->AutosaveCartridgeSaveData();
+	}
+
 	window->StartDearImGuiFrame();
 
 	// Handle drag-and-drop event.
+	// Working out what the file is and reading it is done on another thread, so that the window does not freeze.
 	if (!file_utilities.IsDialogOpen() && !drag_and_drop_filename.empty())
 	{
-		if (CDReader::IsDefinitelyACD(drag_and_drop_filename))
-		{
-			LoadCDFile(drag_and_drop_filename, SDL::IOStream(drag_and_drop_filename, "rb"));
-			emulator->SetPaused(false);
-		}
-		else if (emulator->ValidateSaveStateFile(drag_and_drop_filename))
-		{
-			if (emulator_on)
-				LoadSaveState(drag_and_drop_filename);
-		}
-		else if (LoadCartridgeFile(drag_and_drop_filename))
-		{
-			emulator->SetPaused(false);
-		}
-
+		StartLoadingSoftware(drag_and_drop_filename, nullptr, SoftwareLoader::Type::UNKNOWN);
 		drag_and_drop_filename.clear();
 	}
 
+	FinishLoadingSoftware();
+#ifdef FILE_PATH_SUPPORT
+	library->Update();
+#endif
+
 #ifndef NDEBUG
 	if (dear_imgui_demo_window)
 		ImGui::ShowDemoWindow(&dear_imgui_demo_window);
@@ -2077,16 +2377,18 @@ void Frontend::Update()
 
 			if (ImGui::BeginMenu("Software"))
 			{
+			#ifdef FILE_PATH_SUPPORT
+				PopupButton("Library", library_window, nullptr, std::make_pair(640, 480));
+
+				ImGui::Separator();
+
+			#endif
 				if (ImGui::MenuItem("Load Cartridge File..."))
 				{
 					file_utilities.LoadFile(*window, "Load Cartridge File", nullptr, {{{"Mega Drive Cartridge Software", "bin;md;gen;zip"}}}, [this](const std::filesystem::path &path, SDL::IOStream &&file)
 					{
-						const bool success = LoadCartridgeFile(path, file);
-
-						if (success)
-							emulator->SetPaused(false);
-
-						return success;
+						StartLoadingSoftware(path, std::move(file), SoftwareLoader::Type::CARTRIDGE);
+						return true;
 					});
 				}
 
@@ -2103,10 +2405,7 @@ void Frontend::Update()
 				{
 					file_utilities.LoadFile(*window, "Load CD File", nullptr, {{{"Mega CD Disc Software", "bin;cue;iso;chd"}}}, [this](const std::filesystem::path &path, SDL::IOStream &&file)
 					{
-						if (!LoadCDFile(path, std::move(file)))
-							return false;
-
-						emulator->SetPaused(false);
+						StartLoadingSoftware(path, std::move(file), SoftwareLoader::Type::CD);
 						return true;
 					});
 				}
@@ -2164,8 +2463,8 @@ void Frontend::Update()
 						DoToolTip(recent_software.path);
 					}
 
-					if (selected_software != nullptr && LoadSoftwareFile(selected_software->is_cd_file, selected_software->path))
-						emulator->SetPaused(false);
+					if (selected_software != nullptr)
+						LoadSoftwareFile(selected_software->is_cd_file, selected_software->path);
 				}
 			#endif
 
@@ -2455,6 +2754,8 @@ void Frontend::Update()
 	const auto &clownmdemu = emulator->GetState();
 	const auto &vdp = emulator->GetVDPState();
 
+	WindowPopupRefresh::emulator_paused = !emulator_on || emulator->IsPaused();
+
 	const auto DisplayWindow = []<typename T, typename... Ts>(std::optional<T> &window, Ts&&... arguments)
 	{
 		if (window.has_value())
@@ -2463,6 +2764,9 @@ void Frontend::Update()
 	};
 
 	DisplayWindow(cheats_window, *emulator);
+#ifdef FILE_PATH_SUPPORT
+	DisplayWindow(library_window, *library, [this](const Library::Entry &entry) { LoadSoftwareFile(entry.is_cd_file, entry.path); });
+#endif
 	DisplayWindow(debug_log_window);
 	DisplayWindow(debugging_toggles_window);
 	DisplayWindow(disassembler_window);
@@ -2500,6 +2804,10 @@ void Frontend::Update()
 
 	file_utilities.DisplayFileDialog(drag_and_drop_filename);
 
+	// Let the frame pacer know how long it took to produce this frame, so that it can tell how long it can delay the next one by.
+	// Turbo loading fills half of the frame with extra emulation, so the frame cannot be delayed at all then.
+	frame_pacer.FrameWorkFinished(SDL_GetTicksNS() - update_start_time, !emulator->IsTurboLoading());
+
 	window->FinishDearImGuiFrame();
 
 	PreEventStuff();
@@ -1,8 +1,10 @@
 #ifndef FRONTEND_H
 #define FRONTEND_H
 
+#include <cstdint>
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -13,6 +15,8 @@
 #include "debug-log.h"
 #include "emulator-instance.h"
 #include "file-utilities.h"
+#include "frame-pacer.h"
+#include "software-loader.h"
 #include "windows/common/window-with-framebuffer.h"
 
 template<typename T>
@@ -35,9 +39,10 @@ private:
 	void LoadCartridgeFile(const std::filesystem::path &path, std::vector<cc_u16l> &&file_buffer);
 	bool LoadCartridgeFile(const std::filesystem::path &path, SDL::IOStream &file);
 	bool LoadCartridgeFile(const std::filesystem::path &path);
-	bool LoadCDFile(const std::filesystem::path &path, SDL::IOStream &&file);
-	bool LoadCDFile(const std::filesystem::path &path);
-	bool LoadSoftwareFile(const bool is_cd_file, const std::filesystem::path &path);
+	bool LoadCDFile(const std::filesystem::path &path, std::unique_ptr<DiscPreloader> &&stream, std::unique_ptr<CDReader> &&reader, const std::optional<Hash::Digests> &digests, std::uintmax_t image_size);
+	void LoadSoftwareFile(const bool is_cd_file, const std::filesystem::path &path);
+	void StartLoadingSoftware(const std::filesystem::path &path, SDL::IOStream &&file, SoftwareLoader::Type type);
+	void FinishLoadingSoftware();
 	bool LoadSaveState(SDL::IOStream &file);
 	bool LoadSaveState(const std::filesystem::path &path);
 	bool SaveState(const std::filesystem::path &path);
@@ -53,6 +58,7 @@ public:
 	std::optional<EmulatorInstance> emulator;
 	std::optional<WindowWithFramebuffer> window;
 	unsigned int frame_counter;
+	FramePacer frame_pacer;
 
 	bool tall_double_resolution_mode;
 	bool native_windows;
@@ -63,6 +69,8 @@ public:
 	Frontend(const EmulatorInstance::FramerateCallback &framerate_callback, bool fullscreen = false, const std::filesystem::path &user_data_path = "", const std::filesystem::path &cartridge_path = "", const std::filesystem::path &cd_path = "");
 	void HandleEvent(const SDL_Event &event);
 	void Update();
+	// Returns whether software is still being identified and read on another thread.
+	[[nodiscard]] bool IsLoadingSoftware() const;
 	~Frontend();
 	void WriteSaveData();
 	bool WantsToQuit();
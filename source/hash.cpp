@@ -0,0 +1,403 @@
+#include "hash.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <fmt/format.h>
+
+// Hardware acceleration is detected at run-time on x86, and at compile-time elsewhere.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define HASH_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define HASH_TARGET(FEATURES)
+	#else
+		#include <cpuid.h>
+		#define HASH_TARGET(FEATURES) __attribute__((target(FEATURES)))
+	#endif
+#elif defined(__ARM_FEATURE_CRC32)
+	#include <cstring>
+	#include <arm_acle.h>
+#endif
+
+namespace Hash
+{
+#ifdef HASH_X86
+	struct CPUFeatures
+	{
+		bool pclmul = false;
+		bool sha = false;
+	};
+
+	static const CPUFeatures cpu_features = []()
+	{
+		std::array<unsigned int, 4> leaf_1{}, leaf_7{};
+
+	#ifdef _MSC_VER
+		std::array<int, 4> registers;
+		__cpuid(std::data(registers), 0);
+		const auto maximum_leaf = registers[0];
+
+		if (maximum_leaf >= 1)
+		{
+			__cpuid(std::data(registers), 1);
+			std::copy(std::begin(registers), std::end(registers), std::begin(leaf_1));
+		}
+
+		if (maximum_leaf >= 7)
+		{
+			__cpuidex(std::data(registers), 7, 0);
+			std::copy(std::begin(registers), std::end(registers), std::begin(leaf_7));
+		}
+	#else
+		__get_cpuid(1, &leaf_1[0], &leaf_1[1], &leaf_1[2], &leaf_1[3]);
+		__get_cpuid_count(7, 0, &leaf_7[0], &leaf_7[1], &leaf_7[2], &leaf_7[3]);
+	#endif
+
+		const bool ssse3 = (leaf_1[2] & 1u << 9) != 0;
+		const bool sse4_1 = (leaf_1[2] & 1u << 19) != 0;
+
+		CPUFeatures features;
+		features.pclmul = (leaf_1[2] & 1u << 1) != 0 && sse4_1;
+		features.sha = (leaf_7[1] & 1u << 29) != 0 && ssse3 && sse4_1;
+		return features;
+	}();
+#endif
+
+	///////////
+	// CRC32 //
+	///////////
+
+	// Slicing-by-8: eight tables allow eight bytes to be processed per step, instead of one.
+	static constexpr auto crc32_tables = []()
+	{
+		std::array<std::array<std::uint_least32_t, 0x100>, 8> tables{};
+
+		for (std::uint_least32_t i = 0; i < std::size(tables[0]); ++i)
+		{
+			std::uint_least32_t value = i;
+
+			for (unsigned int bit = 0; bit < 8; ++bit)
+				value = (value >> 1) ^ ((value & 1) != 0 ? 0xEDB88320 : 0);
+
+			tables[0][i] = value;
+		}
+
+		for (std::size_t table = 1; table < std::size(tables); ++table)
+			for (std::size_t i = 0; i < std::size(tables[0]); ++i)
+				tables[table][i] = (tables[table - 1][i] >> 8) ^ tables[0][tables[table - 1][i] & 0xFF];
+
+		return tables;
+	}();
+
+#ifdef HASH_X86
+	// Lambdas do not inherit the target features of their enclosing function, so these have to be functions.
+	HASH_TARGET("sse2") static __m128i Load(const unsigned char* const bytes)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+	}
+
+	HASH_TARGET("pclmul,sse4.1") static __m128i Fold(const __m128i accumulator, const __m128i constants, const __m128i data)
+	{
+		return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(accumulator, constants, 0x00), _mm_clmulepi64_si128(accumulator, constants, 0x11)), data);
+	}
+
+	// Folds the data with carry-less multiplication, as described in Intel's paper
+	// 'Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction'.
+	// 'total_bytes' must be a multiple of 16, and at least 64.
+	HASH_TARGET("pclmul,sse4.1") static std::uint_least32_t UpdateCRC32PCLMUL(const std::uint_least32_t crc, const unsigned char *bytes, std::size_t total_bytes)
+	{
+
+		const __m128i k1k2 = _mm_set_epi64x(0x01C6E41596, 0x0154442BD4);
+		const __m128i k3k4 = _mm_set_epi64x(0x00CCAA009E, 0x01751997D0);
+		const __m128i k5k0 = _mm_set_epi64x(0, 0x0163CD6124);
+		const __m128i polynomial = _mm_set_epi64x(0x01F7011641, 0x01DB710641);
+		const __m128i low_32_bits = _mm_setr_epi32(-1, 0, -1, 0);
+
+		// Fold four blocks at once, to keep the multiplier busy.
+		__m128i x1 = _mm_xor_si128(Load(bytes + 0x00), _mm_cvtsi32_si128(static_cast<int>(crc)));
+		__m128i x2 = Load(bytes + 0x10);
+		__m128i x3 = Load(bytes + 0x20);
+		__m128i x4 = Load(bytes + 0x30);
+
+		bytes += 0x40;
+		total_bytes -= 0x40;
+
+		for (; total_bytes >= 0x40; bytes += 0x40, total_bytes -= 0x40)
+		{
+			x1 = Fold(x1, k1k2, Load(bytes + 0x00));
+			x2 = Fold(x2, k1k2, Load(bytes + 0x10));
+			x3 = Fold(x3, k1k2, Load(bytes + 0x20));
+			x4 = Fold(x4, k1k2, Load(bytes + 0x30));
+		}
+
+		// Fold the four blocks into one, then fold in whatever is left.
+		x1 = Fold(x1, k3k4, x2);
+		x1 = Fold(x1, k3k4, x3);
+		x1 = Fold(x1, k3k4, x4);
+
+		for (; total_bytes >= 0x10; bytes += 0x10, total_bytes -= 0x10)
+			x1 = Fold(x1, k3k4, Load(bytes));
+
+		// Reduce from 128 bits to 64 bits...
+		x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), _mm_clmulepi64_si128(x1, k3k4, 0x10));
+		x1 = _mm_xor_si128(_mm_srli_si128(x1, 4), _mm_clmulepi64_si128(_mm_and_si128(x1, low_32_bits), k5k0, 0x00));
+
+		// ...and then to 32 bits with a Barrett reduction.
+		__m128i x2_reduction = _mm_clmulepi64_si128(_mm_and_si128(x1, low_32_bits), polynomial, 0x10);
+		x2_reduction = _mm_clmulepi64_si128(_mm_and_si128(x2_reduction, low_32_bits), polynomial, 0x00);
+		x1 = _mm_xor_si128(x1, x2_reduction);
+
+		return static_cast<std::uint_least32_t>(_mm_extract_epi32(x1, 1));
+	}
+#endif
+
+	void CRC32::Update(const unsigned char *bytes, std::size_t total_bytes)
+	{
+	#ifdef HASH_X86
+		if (cpu_features.pclmul && total_bytes >= 0x40)
+		{
+			const auto bytes_to_fold = total_bytes & ~static_cast<std::size_t>(0xF);
+			crc = UpdateCRC32PCLMUL(crc, bytes, bytes_to_fold);
+			bytes += bytes_to_fold;
+			total_bytes -= bytes_to_fold;
+		}
+	#elif defined(__ARM_FEATURE_CRC32)
+		for (; total_bytes >= 8; bytes += 8, total_bytes -= 8)
+		{
+			std::uint64_t doubleword;
+			std::memcpy(&doubleword, bytes, sizeof(doubleword));
+			crc = __crc32d(crc, doubleword);
+		}
+	#endif
+
+		const auto &tables = crc32_tables;
+
+		for (; total_bytes >= 8; bytes += 8, total_bytes -= 8)
+		{
+			const auto low = crc ^ (static_cast<std::uint_least32_t>(bytes[0]) << 0 | static_cast<std::uint_least32_t>(bytes[1]) << 8 | static_cast<std::uint_least32_t>(bytes[2]) << 16 | static_cast<std::uint_least32_t>(bytes[3]) << 24);
+
+			crc = tables[7][low >> 0 & 0xFF] ^ tables[6][low >> 8 & 0xFF] ^ tables[5][low >> 16 & 0xFF] ^ tables[4][low >> 24 & 0xFF]
+				^ tables[3][bytes[4]] ^ tables[2][bytes[5]] ^ tables[1][bytes[6]] ^ tables[0][bytes[7]];
+		}
+
+		for (; total_bytes != 0; ++bytes, --total_bytes)
+			crc = (crc >> 8) ^ tables[0][(crc ^ *bytes) & 0xFF];
+	}
+
+	///////////
+	// SHA-1 //
+	///////////
+
+	static std::uint_least32_t RotateLeft(const std::uint_least32_t value, const unsigned int amount)
+	{
+		return ((value << amount) | (value >> (32 - amount))) & 0xFFFFFFFF;
+	}
+
+#ifdef HASH_X86
+	// Uses the SHA extensions, which perform four rounds per instruction.
+	HASH_TARGET("sha,ssse3,sse4.1") static void ProcessSHA1BlocksSHANI(std::array<std::uint_least32_t, 5> &state, const unsigned char *bytes, std::size_t total_blocks)
+	{
+		const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607, 0x08090A0B0C0D0E0F);
+
+		// 'A' goes in the highest lane.
+		__m128i abcd = _mm_set_epi32(static_cast<int>(state[0]), static_cast<int>(state[1]), static_cast<int>(state[2]), static_cast<int>(state[3]));
+		__m128i e_initial = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+
+		for (; total_blocks != 0; --total_blocks, bytes += 64)
+		{
+			const __m128i abcd_saved = abcd;
+			__m128i messages[4];
+			__m128i abcd_previous = abcd;
+			__m128i e = e_initial;
+
+			// This is unrolled by hand, as the round function must be an immediate value.
+		#define DO_GROUP(GROUP) \
+			{ \
+				auto &message = messages[(GROUP) % 4]; \
+ \
+				if ((GROUP) < 4) \
+					message = _mm_shuffle_epi8(Load(bytes + (GROUP) * 16), byte_swap); \
+				else \
+					message = _mm_sha1msg2_epu32(_mm_xor_si128(_mm_sha1msg1_epu32(message, messages[((GROUP) + 1) % 4]), messages[((GROUP) + 2) % 4]), messages[((GROUP) + 3) % 4]); \
+ \
+				e = (GROUP) == 0 ? _mm_add_epi32(e, message) : _mm_sha1nexte_epu32(abcd_previous, message); \
+				abcd_previous = abcd; \
+				abcd = _mm_sha1rnds4_epu32(abcd, e, (GROUP) / 5); \
+			}
+
+			DO_GROUP(0) DO_GROUP(1) DO_GROUP(2) DO_GROUP(3) DO_GROUP(4)
+			DO_GROUP(5) DO_GROUP(6) DO_GROUP(7) DO_GROUP(8) DO_GROUP(9)
+			DO_GROUP(10) DO_GROUP(11) DO_GROUP(12) DO_GROUP(13) DO_GROUP(14)
+			DO_GROUP(15) DO_GROUP(16) DO_GROUP(17) DO_GROUP(18) DO_GROUP(19)
+
+		#undef DO_GROUP
+
+			e_initial = _mm_sha1nexte_epu32(abcd_previous, e_initial);
+			abcd = _mm_add_epi32(abcd, abcd_saved);
+		}
+
+		state[0] = static_cast<std::uint_least32_t>(_mm_extract_epi32(abcd, 3));
+		state[1] = static_cast<std::uint_least32_t>(_mm_extract_epi32(abcd, 2));
+		state[2] = static_cast<std::uint_least32_t>(_mm_extract_epi32(abcd, 1));
+		state[3] = static_cast<std::uint_least32_t>(_mm_extract_epi32(abcd, 0));
+		state[4] = static_cast<std::uint_least32_t>(_mm_extract_epi32(e_initial, 3));
+	}
+#endif
+
+	void SHA1::ProcessBlocks(const unsigned char *bytes, std::size_t total_blocks)
+	{
+	#ifdef HASH_X86
+		if (cpu_features.sha)
+		{
+			ProcessSHA1BlocksSHANI(state, bytes, total_blocks);
+			return;
+		}
+	#endif
+
+		for (; total_blocks != 0; --total_blocks, bytes += 64)
+			ProcessBlock(bytes);
+	}
+
+	void SHA1::ProcessBlock(const unsigned char* const bytes)
+	{
+		std::array<std::uint_least32_t, 80> words;
+
+		for (std::size_t i = 0; i < 16; ++i)
+			words[i] = static_cast<std::uint_least32_t>(bytes[i * 4 + 0]) << 24 | static_cast<std::uint_least32_t>(bytes[i * 4 + 1]) << 16 | static_cast<std::uint_least32_t>(bytes[i * 4 + 2]) << 8 | bytes[i * 4 + 3];
+
+		for (std::size_t i = 16; i < std::size(words); ++i)
+			words[i] = RotateLeft(words[i - 3] ^ words[i - 8] ^ words[i - 14] ^ words[i - 16], 1);
+
+		auto a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+		const auto &DoRound = [&](const std::uint_least32_t f, const std::uint_least32_t k, const std::uint_least32_t word)
+		{
+			const auto temp = (RotateLeft(a, 5) + (f & 0xFFFFFFFF) + e + k + word) & 0xFFFFFFFF;
+			e = d;
+			d = c;
+			c = RotateLeft(b, 30);
+			b = a;
+			a = temp;
+		};
+
+		// Each quarter of the rounds has its own loop, so that the round function is not chosen on every round.
+		for (std::size_t i = 0; i < 20; ++i)
+			DoRound((b & c) | (~b & d), 0x5A827999, words[i]);
+
+		for (std::size_t i = 20; i < 40; ++i)
+			DoRound(b ^ c ^ d, 0x6ED9EBA1, words[i]);
+
+		for (std::size_t i = 40; i < 60; ++i)
+			DoRound((b & c) | (b & d) | (c & d), 0x8F1BBCDC, words[i]);
+
+		for (std::size_t i = 60; i < 80; ++i)
+			DoRound(b ^ c ^ d, 0xCA62C1D6, words[i]);
+
+		state[0] = (state[0] + a) & 0xFFFFFFFF;
+		state[1] = (state[1] + b) & 0xFFFFFFFF;
+		state[2] = (state[2] + c) & 0xFFFFFFFF;
+		state[3] = (state[3] + d) & 0xFFFFFFFF;
+		state[4] = (state[4] + e) & 0xFFFFFFFF;
+	}
+
+	void SHA1::Update(const unsigned char *bytes, std::size_t total_bytes)
+	{
+		total_bytes_hashed += total_bytes;
+
+		// Top-up a partially-filled block first.
+		if (block_position != 0)
+		{
+			const auto bytes_to_copy = std::min(std::size(block) - block_position, total_bytes);
+			std::copy(bytes, bytes + bytes_to_copy, std::begin(block) + block_position);
+			block_position += bytes_to_copy;
+			bytes += bytes_to_copy;
+			total_bytes -= bytes_to_copy;
+
+			if (block_position != std::size(block))
+				return;
+
+			ProcessBlocks(std::data(block), 1);
+			block_position = 0;
+		}
+
+		// Whole blocks are hashed in-place, without copying.
+		const auto total_blocks = total_bytes / std::size(block);
+		ProcessBlocks(bytes, total_blocks);
+		bytes += total_blocks * std::size(block);
+		total_bytes -= total_blocks * std::size(block);
+
+		std::copy(bytes, bytes + total_bytes, std::begin(block));
+		block_position = total_bytes;
+	}
+
+	SHA1::Digest SHA1::Finish()
+	{
+		const std::uint_least64_t total_bits = total_bytes_hashed * 8;
+
+		static constexpr unsigned char terminator = 0x80;
+		Update(&terminator, 1);
+
+		static constexpr std::array<unsigned char, 64> padding{};
+		Update(std::data(padding), (std::size(block) * 2 - 8 - block_position) % std::size(block));
+
+		std::array<unsigned char, 8> length;
+		for (std::size_t i = 0; i < std::size(length); ++i)
+			length[i] = (total_bits >> ((std::size(length) - 1 - i) * 8)) & 0xFF;
+		Update(std::data(length), std::size(length));
+
+		Digest digest;
+		for (std::size_t i = 0; i < std::size(digest); ++i)
+			digest[i] = (state[i / 4] >> ((3 - i % 4) * 8)) & 0xFF;
+
+		return digest;
+	}
+
+	////////////
+	// Hasher //
+	////////////
+
+	void Hasher::Update(const unsigned char* const bytes, const std::size_t total_bytes)
+	{
+		crc32.Update(bytes, total_bytes);
+		sha1.Update(bytes, total_bytes);
+	}
+
+	void Hasher::Update(const cc_u16l* const words, const std::size_t total_words)
+	{
+		// Convert in small chunks so that large ROMs do not need a second copy.
+		std::array<unsigned char, 0x1000> bytes;
+
+		for (std::size_t word_index = 0; word_index < total_words; )
+		{
+			const auto words_to_do = std::min(std::size(bytes) / 2, total_words - word_index);
+
+			for (std::size_t i = 0; i < words_to_do; ++i)
+			{
+				const auto word = words[word_index + i];
+				bytes[i * 2 + 0] = (word >> 8) & 0xFF;
+				bytes[i * 2 + 1] = (word >> 0) & 0xFF;
+			}
+
+			Update(std::data(bytes), words_to_do * 2);
+			word_index += words_to_do;
+		}
+	}
+
+	Digests Hasher::Finish()
+	{
+		return {crc32.Finish(), sha1.Finish()};
+	}
+
+	std::string ToHexString(const SHA1::Digest &digest)
+	{
+		std::string string;
+		string.reserve(std::size(digest) * 2);
+
+		for (const auto byte : digest)
+			fmt::format_to(std::back_inserter(string), "{:02x}", byte);
+
+		return string;
+	}
+}
@@ -0,0 +1,67 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "../common/core/libraries/clowncommon/clowncommon.h"
+
+namespace Hash
+{
+	class CRC32
+	{
+	private:
+		std::uint_least32_t crc = 0xFFFFFFFF;
+
+	public:
+		void Update(const unsigned char *bytes, std::size_t total_bytes);
+		[[nodiscard]] std::uint_least32_t Finish() const
+		{
+			return crc ^ 0xFFFFFFFF;
+		}
+	};
+
+	class SHA1
+	{
+	public:
+		using Digest = std::array<unsigned char, 20>;
+
+	private:
+		std::array<std::uint_least32_t, 5> state = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+		std::array<unsigned char, 64> block;
+		std::size_t block_position = 0;
+		std::uint_least64_t total_bytes_hashed = 0;
+
+		void ProcessBlock(const unsigned char *bytes);
+		void ProcessBlocks(const unsigned char *bytes, std::size_t total_blocks);
+
+	public:
+		void Update(const unsigned char *bytes, std::size_t total_bytes);
+		[[nodiscard]] Digest Finish();
+	};
+
+	struct Digests
+	{
+		std::uint_least32_t crc32;
+		SHA1::Digest sha1;
+	};
+
+	class Hasher
+	{
+	private:
+		CRC32 crc32;
+		SHA1 sha1;
+
+	public:
+		void Update(const unsigned char *bytes, std::size_t total_bytes);
+		// ROMs and sectors are held as big-endian words, so they are hashed as the bytes that they were read from.
+		void Update(const cc_u16l *words, std::size_t total_words);
+		[[nodiscard]] Digests Finish();
+	};
+
+	[[nodiscard]] std::string ToHexString(const SHA1::Digest &digest);
+}
+
+#endif /* HASH_H */
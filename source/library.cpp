@@ -0,0 +1,462 @@
+#include "library.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <map>
+#include <new>
+#include <set>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "cd-reader.h"
+#include "file-utilities.h"
+#include "save-data-writer.h"
+#include "software-probe.h"
+#include "text-encoding.h"
+
+// Anything larger than this is not a cartridge, and would take too long to read.
+static constexpr Sint64 maximum_cartridge_size = 64 * 1024 * 1024;
+static constexpr std::array<char, 8> index_magic = {'C', 'M', 'D', 'E', 'L', 'I', 'B', '1'};
+
+static std::string ToLower(std::string string)
+{
+	std::transform(std::begin(string), std::end(string), std::begin(string), [](const unsigned char character) { return std::tolower(character); });
+	return string;
+}
+
+static std::string ReadRegions(const unsigned char* const header)
+{
+	// The region codes are plain ASCII, padded with spaces.
+	std::string regions;
+
+	for (std::size_t i = 0x1F0; i < 0x200; ++i)
+		if (header[i] > ' ' && header[i] < 0x7F)
+			regions += static_cast<char>(header[i]);
+
+	return regions;
+}
+
+std::string Library::Entry::GetName() const
+{
+	if (!overseas_name.empty())
+		return overseas_name;
+
+	if (!domestic_name.empty())
+		return domestic_name;
+
+	return FileUtilities::PathToStringView(path.stem(), [](const std::string_view &string) { return std::string(string); });
+}
+
+std::vector<Library::Candidate> Library::FindCandidates(const std::vector<std::filesystem::path> &directories, const std::atomic<bool> &cancelled)
+{
+	static const std::set<std::string, std::less<>> extensions = {".bin", ".md", ".gen", ".zip", ".cue", ".iso", ".chd"};
+
+	std::vector<Candidate> candidates;
+	std::set<std::filesystem::path> cue_tracks;
+
+	const auto &AddCueTracks = [&](const std::filesystem::path &cue_path)
+	{
+		// Track files are listed by their cue sheet, so they should not be listed again on their own.
+		for (auto &track_path : CDReader::GetCueSheetFiles(cue_path))
+			cue_tracks.insert(std::move(track_path));
+	};
+
+	for (const auto &directory : directories)
+	{
+		std::error_code error;
+
+		for (auto iterator = std::filesystem::recursive_directory_iterator(directory, std::filesystem::directory_options::skip_permission_denied, error); !error && iterator != std::filesystem::recursive_directory_iterator(); iterator.increment(error))
+		{
+			if (cancelled)
+				return {};
+
+			const auto &directory_entry = *iterator;
+
+			if (!directory_entry.is_regular_file(error))
+				continue;
+
+			const auto extension = ToLower(directory_entry.path().extension().string());
+
+			if (!extensions.contains(extension))
+				continue;
+
+			const auto size = directory_entry.file_size(error);
+			if (error)
+				continue;
+
+			const auto modification_time = directory_entry.last_write_time(error);
+			if (error)
+				continue;
+
+			if (extension == ".cue")
+				AddCueTracks(directory_entry.path());
+
+			candidates.push_back({directory_entry.path(), size, modification_time.time_since_epoch().count()});
+		}
+	}
+
+	std::erase_if(candidates, [&](const Candidate &candidate) { return cue_tracks.contains(candidate.path); });
+
+	return candidates;
+}
+
+std::optional<Library::Entry> Library::ReadEntry(const Candidate &candidate)
+{
+	auto probe = SoftwareProbe::Probe(candidate.path);
+
+	if (!probe.has_value())
+		return std::nullopt;
+
+	Entry entry{candidate.path, candidate.size, candidate.modification_time, false, {}, {}, {}, {}};
+
+	const auto &ReadHeader = [&](const unsigned char* const header)
+	{
+		entry.domestic_name = DecodeHeaderName(&header[0x120], 0x30);
+		entry.overseas_name = DecodeHeaderName(&header[0x150], 0x30);
+		entry.regions = ReadRegions(header);
+	};
+
+	switch (probe->descriptor.type)
+	{
+		case SoftwareProbe::Type::CARTRIDGE:
+		{
+			// Disc images without a Mega CD header are of no use to us.
+			if (probe->descriptor.size > maximum_cartridge_size || ToLower(candidate.path.extension().string()) == ".iso")
+				return std::nullopt;
+
+			try
+			{
+				auto words = FileUtilities::LoadZIPFileToBuffer(probe->file);
+
+				if (!words.has_value())
+				{
+					std::vector<unsigned char> bytes(probe->descriptor.size);
+
+					if (SDL_ReadIO(probe->file, std::data(bytes), std::size(bytes)) != std::size(bytes))
+						return std::nullopt;
+
+					words.emplace(CC_DIVIDE_CEILING(std::size(bytes), 2));
+					FileUtilities::BytesToWords(std::data(bytes), std::size(bytes), std::data(*words));
+				}
+
+				std::array<unsigned char, 0x200> header{};
+
+				for (std::size_t i = 0; i < std::min(std::size(header) / 2, std::size(*words)); ++i)
+				{
+					header[i * 2 + 0] = ((*words)[i] >> 8) & 0xFF;
+					header[i * 2 + 1] = ((*words)[i] >> 0) & 0xFF;
+				}
+
+				ReadHeader(std::data(header));
+
+				Hash::Hasher hasher;
+				hasher.Update(std::data(*words), std::size(*words));
+				entry.digests = hasher.Finish();
+			}
+			catch (const std::bad_alloc&)
+			{
+				return std::nullopt;
+			}
+
+			break;
+		}
+
+		case SoftwareProbe::Type::CD:
+		{
+			// The probe's stream is not needed; the CD reader opens the file itself, along with any track files.
+			probe->file.reset();
+
+			CDReader cd_reader(candidate.path);
+
+			if (!cd_reader.IsOpen())
+				return std::nullopt;
+
+			std::array<unsigned char, CDReader::SECTOR_SIZE> header;
+
+			if (!cd_reader.ReadMegaCDHeaderSector(std::data(header)))
+				return std::nullopt;
+
+			ReadHeader(std::data(header));
+
+			// This matches the hash that the emulator computes when the disc is inserted.
+			const auto digests = cd_reader.HashDataTrack();
+
+			if (!digests.has_value())
+				return std::nullopt;
+
+			entry.digests = *digests;
+			entry.is_cd_file = true;
+			break;
+		}
+
+		case SoftwareProbe::Type::UNKNOWN:
+		case SoftwareProbe::Type::SAVE_STATE:
+			return std::nullopt;
+	}
+
+	return entry;
+}
+
+void Library::Scan(const std::vector<std::filesystem::path> &directories, const std::vector<Entry> &previous_entries)
+{
+	const Uint64 start_time = SDL_GetTicksNS();
+
+	const auto candidates = FindCandidates(directories, cancelled);
+	files_found = std::size(candidates);
+
+	std::map<std::filesystem::path, const Entry*> previous_entries_by_path;
+	for (const auto &entry : previous_entries)
+		previous_entries_by_path.emplace(entry.path, &entry);
+
+	std::vector<std::optional<Entry>> results(std::size(candidates));
+	std::atomic<std::size_t> next_candidate = 0;
+
+	const auto &Worker = [&]()
+	{
+		CDReader::errors_silenced = true;
+
+		for (;;)
+		{
+			const std::size_t index = next_candidate++;
+
+			if (index >= std::size(candidates) || cancelled)
+				break;
+
+			const auto &candidate = candidates[index];
+			const auto &previous_entry = previous_entries_by_path.find(candidate.path);
+
+			// Unchanged files do not need to be read again.
+			if (previous_entry != std::end(previous_entries_by_path) && previous_entry->second->size == candidate.size && previous_entry->second->modification_time == candidate.modification_time)
+				results[index] = *previous_entry->second;
+			else
+				results[index] = ReadEntry(candidate);
+
+			++files_scanned;
+		}
+	};
+
+	// Reading headers is mostly waiting on the disk, so spread it over multiple threads.
+	std::vector<std::thread> workers;
+
+	for (unsigned int i = 1; i < std::max(1u, std::thread::hardware_concurrency()); ++i)
+	{
+		try
+		{
+			workers.emplace_back(Worker);
+		}
+		catch (const std::system_error&)
+		{
+			// Threads are unavailable, so make do with the ones that we have.
+			break;
+		}
+	}
+
+	Worker();
+
+	for (auto &worker : workers)
+		worker.join();
+
+	if (cancelled)
+	{
+		finished = true;
+		return;
+	}
+
+	for (auto &result : results)
+		if (result.has_value())
+			scanned_entries.push_back(std::move(*result));
+
+	std::sort(std::begin(scanned_entries), std::end(scanned_entries), [](const Entry &a, const Entry &b)
+	{
+		const auto a_name = ToLower(a.GetName()), b_name = ToLower(b.GetName());
+		return a_name != b_name ? a_name < b_name : a.path < b.path;
+	});
+
+	SaveIndex(index_path, scanned_entries);
+
+	scan_duration = static_cast<float>(SDL_GetTicksNS() - start_time) / SDL_NS_PER_SECOND;
+	finished = true;
+}
+
+/////////////////
+// Index Files //
+/////////////////
+
+std::vector<Library::Entry> Library::LoadIndex(const std::filesystem::path &index_path)
+{
+	SDL::IOStream file(index_path, "rb");
+
+	if (!file)
+		return {};
+
+	std::array<char, std::size(index_magic)> magic;
+	Uint32 total_entries;
+
+	if (SDL_ReadIO(file, std::data(magic), std::size(magic)) != std::size(magic) || magic != index_magic || !SDL_ReadU32LE(file, &total_entries))
+		return {};
+
+	const auto &ReadString = [&](std::string &string)
+	{
+		Uint16 length;
+
+		if (!SDL_ReadU16LE(file, &length))
+			return false;
+
+		string.resize(length);
+		return SDL_ReadIO(file, std::data(string), length) == length;
+	};
+
+	std::vector<Entry> entries;
+
+	for (Uint32 i = 0; i < total_entries; ++i)
+	{
+		Entry entry;
+		std::string path;
+		Uint64 size;
+		Sint64 modification_time;
+		Uint8 is_cd_file;
+		Uint32 crc32;
+
+		if (!ReadString(path)
+			|| !SDL_ReadU64LE(file, &size)
+			|| !SDL_ReadS64LE(file, &modification_time)
+			|| !SDL_ReadU8(file, &is_cd_file)
+			|| !ReadString(entry.domestic_name)
+			|| !ReadString(entry.overseas_name)
+			|| !ReadString(entry.regions)
+			|| !SDL_ReadU32LE(file, &crc32)
+			|| SDL_ReadIO(file, std::data(entry.digests.sha1), std::size(entry.digests.sha1)) != std::size(entry.digests.sha1))
+		{
+			// A truncated index is as good as no index.
+			return {};
+		}
+
+		entry.path = FileUtilities::U8Path(path);
+		entry.size = size;
+		entry.modification_time = modification_time;
+		entry.is_cd_file = is_cd_file != 0;
+		entry.digests.crc32 = crc32;
+		entries.push_back(std::move(entry));
+	}
+
+	return entries;
+}
+
+bool Library::SaveIndex(const std::filesystem::path &index_path, const std::vector<Entry> &entries)
+{
+	// The index is built in memory and then written in one go, so that a crash cannot leave a partially-written index behind.
+	SDL::IOStream file;
+
+	if (!file)
+		return false;
+
+	const auto &WriteString = [&](const std::string_view &string)
+	{
+		const auto length = std::min<std::size_t>(std::size(string), 0xFFFF);
+		return SDL_WriteU16LE(file, static_cast<Uint16>(length)) && SDL_WriteIO(file, std::data(string), length) == length;
+	};
+
+	bool success = SDL_WriteIO(file, std::data(index_magic), std::size(index_magic)) == std::size(index_magic)
+		&& SDL_WriteU32LE(file, static_cast<Uint32>(std::size(entries)));
+
+	for (const auto &entry : entries)
+	{
+		success = success
+			&& FileUtilities::PathToStringView(entry.path, WriteString)
+			&& SDL_WriteU64LE(file, entry.size)
+			&& SDL_WriteS64LE(file, entry.modification_time)
+			&& SDL_WriteU8(file, entry.is_cd_file)
+			&& WriteString(entry.domestic_name)
+			&& WriteString(entry.overseas_name)
+			&& WriteString(entry.regions)
+			&& SDL_WriteU32LE(file, entry.digests.crc32)
+			&& SDL_WriteIO(file, std::data(entry.digests.sha1), std::size(entry.digests.sha1)) == std::size(entry.digests.sha1);
+	}
+
+	if (!success)
+		return false;
+
+	return SaveDataWriter::WriteFileAtomically(index_path, SDL_GetPointerProperty(SDL_GetIOProperties(file), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, nullptr), SDL_GetIOSize(file));
+}
+
+////////////
+// Public //
+////////////
+
+Library::Library(const std::filesystem::path &index_path)
+	: index_path(index_path)
+{}
+
+Library::~Library()
+{
+	cancelled = true;
+	JoinThread();
+}
+
+void Library::JoinThread()
+{
+	if (thread.joinable())
+		thread.join();
+}
+
+void Library::StartScan()
+{
+	// Rather than waiting for the running scan to stop, let 'Update' start the new one once it has.
+	if (IsScanning())
+	{
+		cancelled = true;
+		rescan_pending = true;
+		return;
+	}
+
+	// The index is only needed once the library is actually used, so it is not loaded at start-up.
+	if (!index_loaded)
+	{
+		entries = LoadIndex(index_path);
+		index_loaded = true;
+	}
+
+	JoinThread();
+
+	files_found = 0;
+	files_scanned = 0;
+	finished = false;
+	cancelled = false;
+	scanned_entries.clear();
+
+	try
+	{
+		// The thread gets its own copies, so that the directories and entries can be changed while it runs.
+		thread = std::thread([this, directories = directories, previous_entries = entries]() { Scan(directories, previous_entries); });
+	}
+	catch (const std::system_error&)
+	{
+		// Threads are unavailable, so just scan here instead.
+		Scan(directories, entries);
+	}
+}
+
+void Library::Update()
+{
+	if (!finished)
+		return;
+
+	JoinThread();
+	finished = false;
+
+	if (!cancelled)
+	{
+		entries = std::move(scanned_entries);
+		last_scan_duration = scan_duration;
+	}
+
+	scanned_entries.clear();
+
+	if (rescan_pending)
+	{
+		rescan_pending = false;
+		StartScan();
+	}
+}
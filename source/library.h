@@ -0,0 +1,87 @@
+#ifndef LIBRARY_H
+#define LIBRARY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hash.h"
+
+// Scans directories for cartridge and disc images, and keeps an index of them in the configuration directory.
+// Rescans only read files which are new or whose size or modification time has changed.
+class Library
+{
+public:
+	struct Entry
+	{
+		std::filesystem::path path;
+		std::uint_least64_t size;
+		std::int_least64_t modification_time;
+		bool is_cd_file;
+		std::string domestic_name;
+		std::string overseas_name;
+		std::string regions;
+		// For discs, this covers only the first few sectors, as hashing whole discs would make scans far too slow.
+		Hash::Digests digests;
+
+		[[nodiscard]] std::string GetName() const;
+	};
+
+private:
+	struct Candidate
+	{
+		std::filesystem::path path;
+		std::uint_least64_t size;
+		std::int_least64_t modification_time;
+	};
+
+	std::filesystem::path index_path;
+	bool index_loaded = false;
+	std::vector<Entry> entries;
+
+	std::thread thread;
+	std::atomic<std::size_t> files_found = 0;
+	std::atomic<std::size_t> files_scanned = 0;
+	std::atomic<bool> finished = false;
+	std::atomic<bool> cancelled = false;
+	// Set when the directories change during a scan, which makes that scan out of date.
+	bool rescan_pending = false;
+	std::vector<Entry> scanned_entries;
+	float scan_duration = 0.0f; // In seconds.
+	std::optional<float> last_scan_duration;
+
+	void Scan(const std::vector<std::filesystem::path> &directories, const std::vector<Entry> &previous_entries);
+	static std::vector<Candidate> FindCandidates(const std::vector<std::filesystem::path> &directories, const std::atomic<bool> &cancelled);
+	static std::optional<Entry> ReadEntry(const Candidate &candidate);
+	static std::vector<Entry> LoadIndex(const std::filesystem::path &index_path);
+	static bool SaveIndex(const std::filesystem::path &index_path, const std::vector<Entry> &entries);
+	void JoinThread();
+
+public:
+	std::vector<std::filesystem::path> directories;
+
+	Library(const std::filesystem::path &index_path);
+	~Library();
+	Library(const Library &other) = delete;
+	Library(Library &&other) = delete;
+	Library& operator=(const Library &other) = delete;
+	Library& operator=(Library &&other) = delete;
+
+	// If a scan is already running, then it is cancelled, and a new one is started once it has stopped.
+	void StartScan();
+	// Collects the results of a finished scan. Call this regularly on the main thread.
+	void Update();
+	[[nodiscard]] bool IsScanning() const { return (thread.joinable() && !finished) || rescan_pending; }
+	[[nodiscard]] std::size_t GetFilesFound() const { return files_found; }
+	[[nodiscard]] std::size_t GetFilesScanned() const { return files_scanned; }
+	[[nodiscard]] const std::vector<Entry>& GetEntries() const { return entries; }
+	// In seconds. Returns nothing if no scan has finished yet.
+	[[nodiscard]] std::optional<float> GetLastScanDuration() const { return last_scan_duration; }
+};
+
+#endif /* LIBRARY_H */
@@ -15,13 +15,9 @@
 
 #include "file-utilities.h"
 #include "frontend.h"
-#include "tar.h"
+#include "startup-report.h"
 #include "version.h"
-
-namespace CompressedGameControllerDB
-{
-	#include "../../assets/gamecontrollerdb/archive.tar.lzma.h"
-}
+#include "windows/common/window.h"
 
 template<typename... Args>
 static bool InitialiseSDLAndFrontend(Args &&...args)
@@ -34,10 +30,10 @@ static bool InitialiseSDLAndFrontend(Args &&...args)
 		return false;
 	}
 
-	// Load additional controller mappings.
-	const auto archive = TarBall(CompressedGameControllerDB::buffer, CompressedGameControllerDB::uncompressed_size, TarBall::Compression::LZMA);
-	const auto mappings = archive.OpenFile("SDL_GameControllerDB/gamecontrollerdb.txt").value();
-	SDL_AddGamepadMappingsFromIO(SDL::IOStream(std::data(mappings), std::size(mappings)), false);
+	// Get the window icon decoding in the background while the frontend starts up.
+	Window::StartLoadingIcon();
+
+	StartupReport::EndPhase("SDL");
 
 	frontend.emplace(std::forward<Args>(args)...);
 	return true;
@@ -153,12 +149,16 @@ SDL_AppResult SDL_AppInit([[maybe_unused]] void** const appstate, const int argc
 {
 	std::string user_data_path_raw, cartridge_path_raw, cd_path_raw, cartridge_or_cd_path_raw;
 	bool fullscreen = false;
+	bool startup_report = false;
 	bool help = false;
 
 	const auto cli = lyra::help(help).description("ClownMDEmu " VERSION " - A Sega Mega Drive emulator.")
 		| lyra::opt(fullscreen)
 			["-f"]["--fullscreen"]
 			("Start the emulator in fullscreen.")
+		| lyra::opt(startup_report)
+			["--startup-report"]
+			("Print how long each part of start-up took.")
 		| lyra::opt(user_data_path_raw, "path")
 			["-u"]["--user"]
 			("Directory to store user data, such as settings and save data.")
@@ -187,6 +187,9 @@ SDL_AppResult SDL_AppInit([[maybe_unused]] void** const appstate, const int argc
 		return SDL_APP_SUCCESS;
 	}
 
+	if (startup_report)
+		StartupReport::Enable();
+
 	auto user_data_path = FileUtilities::U8Path(user_data_path_raw);
 	auto cartridge_path = FileUtilities::U8Path(cartridge_path_raw);
 	auto cd_path = FileUtilities::U8Path(cd_path_raw);
@@ -213,20 +216,26 @@ SDL_AppResult SDL_AppInit([[maybe_unused]] void** const appstate, const int argc
 
 SDL_AppResult SDL_AppIterate([[maybe_unused]] void* const appstate)
 {
-	static Uint64 next_time;
+	auto &emulator = *frontend->emulator;
 
-	const Uint64 current_time = SDL_GetTicksNS();
+	// The audio queue cannot pace the emulator if nothing is draining it, or if the emulator is meant to outrun it.
+	const bool audio_usable = emulator.IsAudioPlaying() && !emulator.IsFastForwarding();
 
-	if (current_time < next_time)
+	if (!frontend->frame_pacer.ShouldRunFrame(SDL_GetTicksNS(), time_delta, frontend->window->GetVSync(), frontend->window->GetSDLWindow(), audio_usable, audio_usable ? emulator.GetAudioQueuedFrames() : 0, emulator.GetAudioTargetFrames()))
 		return SDL_APP_CONTINUE;
 
-	// If massively delayed, resynchronise to avoid fast-forwarding.
-	if (current_time >= next_time + SDL_NS_PER_SECOND / 10)
-		next_time = current_time;
-
-	next_time += time_delta;
+	// Software that is still being loaded is only inserted at the end of the frame, so that frame does not count as the first.
+	const bool loading_software = frontend->IsLoadingSoftware();
 
 	frontend->Update();
+	frontend->frame_pacer.FrameFinished(SDL_GetTicksNS());
+
+	if (!loading_software)
+	{
+		StartupReport::EndPhase("First frame");
+		StartupReport::Print();
+	}
+
 	return frontend->WantsToQuit() ? SDL_APP_SUCCESS : SDL_APP_CONTINUE;
 }
 
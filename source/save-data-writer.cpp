@@ -0,0 +1,209 @@
+#include "save-data-writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <iterator>
+#include <system_error>
+
+#include <SDL3/SDL.h>
+
+#ifdef SDL_PLATFORM_WIN32
+ #define WIN32_LEAN_AND_MEAN
+ #include <windows.h>
+#else
+ #include <fcntl.h>
+ #include <stdio.h>
+ #include <unistd.h>
+#endif
+
+#include "debug-log.h"
+
+void SaveDataWriter::Worker()
+{
+	std::unique_lock lock(mutex);
+
+	for (;;)
+	{
+		job_available.wait(lock, [&]() { return stopping || !jobs.empty(); });
+
+		// Finish any outstanding writes before stopping, so that no saves are lost on exit.
+		if (jobs.empty())
+			break;
+
+		auto job = std::move(jobs.front());
+		jobs.pop_front();
+		busy = true;
+
+		lock.unlock();
+
+		const bool success = WriteFileAtomically(job.path, std::data(job.data), std::size(job.data));
+
+		lock.lock();
+
+		if (!success)
+			failed_paths.push_back(std::move(job.path));
+
+		busy = false;
+		jobs_finished.notify_all();
+	}
+}
+
+SaveDataWriter::~SaveDataWriter()
+{
+	if (thread.joinable())
+	{
+		{
+			const std::lock_guard lock(mutex);
+			stopping = true;
+		}
+
+		job_available.notify_all();
+		thread.join();
+	}
+}
+
+void SaveDataWriter::Write(const std::filesystem::path &path, std::vector<unsigned char> &&data)
+{
+	if (!thread.joinable())
+	{
+		try
+		{
+			thread = std::thread(&SaveDataWriter::Worker, this);
+		}
+		catch (const std::system_error&)
+		{
+			// Threads are unavailable, so just write the file here instead.
+			// The failure is still left for 'ReportFailures' to log, as this may not be the main thread.
+			if (!WriteFileAtomically(path, std::data(data), std::size(data)))
+			{
+				const std::lock_guard lock(mutex);
+				failed_paths.push_back(path);
+			}
+
+			return;
+		}
+	}
+
+	{
+		const std::lock_guard lock(mutex);
+
+		// An older copy of this file that has not been written yet is now redundant.
+		const auto found = std::find_if(std::begin(jobs), std::end(jobs), [&](const Job &job) { return job.path == path; });
+
+		if (found != std::end(jobs))
+			found->data = std::move(data);
+		else
+			jobs.push_back({path, std::move(data)});
+	}
+
+	job_available.notify_one();
+}
+
+void SaveDataWriter::Flush()
+{
+	std::unique_lock lock(mutex);
+	jobs_finished.wait(lock, [&]() { return jobs.empty() && !busy; });
+}
+
+std::vector<std::filesystem::path> SaveDataWriter::ReportFailures()
+{
+	std::vector<std::filesystem::path> paths;
+
+	{
+		const std::lock_guard lock(mutex);
+		std::swap(paths, failed_paths);
+	}
+
+	for (const auto &path : paths)
+		debug_log.Log("Could not write save data to '{}'", path.string());
+
+	return paths;
+}
+
+// Writes a file and makes sure that it has reached the disk, rather than just the OS's cache, before returning.
+static bool WriteAndSyncFile(const std::filesystem::path &path, const void* const data, const std::size_t size)
+{
+	const auto bytes = static_cast<const unsigned char*>(data);
+
+#ifdef SDL_PLATFORM_WIN32
+	const HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	bool success = true;
+
+	for (std::size_t position = 0; success && position != size; )
+	{
+		DWORD bytes_written;
+		const auto bytes_to_write = static_cast<DWORD>(std::min<std::size_t>(size - position, 0x40000000));
+
+		success = WriteFile(file, &bytes[position], bytes_to_write, &bytes_written, nullptr) && bytes_written != 0;
+		position += bytes_written;
+	}
+
+	success = success && FlushFileBuffers(file);
+
+	return CloseHandle(file) && success;
+#else
+	const int file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+
+	if (file == -1)
+		return false;
+
+	bool success = true;
+
+	for (std::size_t position = 0; success && position != size; )
+	{
+		const auto bytes_written = write(file, &bytes[position], size - position);
+
+		if (bytes_written > 0)
+			position += bytes_written;
+		else if (bytes_written == 0 || errno != EINTR)
+			success = false;
+	}
+
+	success = success && fsync(file) == 0;
+
+	return close(file) == 0 && success;
+#endif
+}
+
+static bool ReplaceFile(const std::filesystem::path &source_path, const std::filesystem::path &destination_path)
+{
+#ifdef SDL_PLATFORM_WIN32
+	// Do not return until the rename itself has reached the disk too.
+	return MoveFileExW(source_path.c_str(), destination_path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+	if (rename(source_path.c_str(), destination_path.c_str()) != 0)
+		return false;
+
+	// The rename is only an update to the directory, so that must be synced too for it to survive a power cut.
+	// Not every filesystem allows directories to be synced, so this is only done on a best-effort basis.
+	const auto directory_path = destination_path.has_parent_path() ? destination_path.parent_path() : std::filesystem::path(".");
+	const int directory = open(directory_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+	if (directory != -1)
+	{
+		fsync(directory);
+		close(directory);
+	}
+
+	return true;
+#endif
+}
+
+bool SaveDataWriter::WriteFileAtomically(const std::filesystem::path &path, const void* const data, const std::size_t size)
+{
+	// Write to a temporary file first, so that a crash or power cut part-way through cannot corrupt the existing file.
+	auto temporary_path = path;
+	temporary_path += ".tmp";
+
+	if (WriteAndSyncFile(temporary_path, data, size) && ReplaceFile(temporary_path, path))
+		return true;
+
+	// Do not leave the incomplete file lying around.
+	std::error_code error;
+	std::filesystem::remove(temporary_path, error);
+	return false;
+}
@@ -0,0 +1,53 @@
+#ifndef SAVE_DATA_WRITER_H
+#define SAVE_DATA_WRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Writes files on a background thread, so that autosaving does not stall the emulator.
+// Files are replaced atomically and synced to the disk, so neither a crash nor a power cut can leave a partially-written save behind.
+class SaveDataWriter
+{
+private:
+	struct Job
+	{
+		std::filesystem::path path;
+		std::vector<unsigned char> data;
+	};
+
+	std::thread thread;
+	std::deque<Job> jobs;
+	std::vector<std::filesystem::path> failed_paths;
+	std::mutex mutex;
+	std::condition_variable job_available;
+	std::condition_variable jobs_finished;
+	bool busy = false;
+	bool stopping = false;
+
+	void Worker();
+
+public:
+	SaveDataWriter() = default;
+	~SaveDataWriter();
+	SaveDataWriter(const SaveDataWriter &other) = delete;
+	SaveDataWriter(SaveDataWriter &&other) = delete;
+	SaveDataWriter& operator=(const SaveDataWriter &other) = delete;
+	SaveDataWriter& operator=(SaveDataWriter &&other) = delete;
+
+	void Write(const std::filesystem::path &path, std::vector<unsigned char> &&data);
+	// Blocks until every queued file has been written.
+	void Flush();
+	// Logs any files that could not be written, and returns their paths so that they can be retried.
+	// The debug log is not thread-safe, so call this from the main thread.
+	std::vector<std::filesystem::path> ReportFailures();
+
+	static bool WriteFileAtomically(const std::filesystem::path &path, const void *data, std::size_t size);
+};
+
+#endif /* SAVE_DATA_WRITER_H */
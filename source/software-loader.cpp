@@ -0,0 +1,167 @@
+#include "software-loader.h"
+
+#include <algorithm>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#include "file-utilities.h"
+
+std::optional<std::vector<cc_u16l>> SoftwareLoader::LoadCartridge()
+{
+	std::optional<std::vector<cc_u16l>> file_buffer;
+
+	try
+	{
+		// First try loading the file as a ZIP file.
+		file_buffer = FileUtilities::LoadZIPFileToBuffer(file);
+
+		if (file_buffer.has_value())
+			return file_buffer;
+
+		// Failing that, just load it as a raw binary.
+		// This is read in chunks so that progress can be reported and so that we can bail out quickly when cancelled.
+		std::vector<unsigned char> bytes(total_bytes);
+
+		constexpr Sint64 chunk_size = 1024 * 1024;
+
+		for (Sint64 position = 0; position != total_bytes; )
+		{
+			if (cancelled)
+				return std::nullopt;
+
+			const auto bytes_to_read = static_cast<std::size_t>(std::min(chunk_size, total_bytes - position));
+
+			if (SDL_ReadIO(file, &bytes[position], bytes_to_read) != bytes_to_read)
+				return std::nullopt;
+
+			position += bytes_to_read;
+			bytes_loaded = position;
+		}
+
+		file_buffer.emplace(CC_DIVIDE_CEILING(std::size(bytes), 2));
+		FileUtilities::BytesToWords(std::data(bytes), std::size(bytes), std::data(*file_buffer));
+	}
+	catch (const std::bad_alloc&)
+	{
+		return std::nullopt;
+	}
+
+	return file_buffer;
+}
+
+bool SoftwareLoader::OpenCD(Result &result)
+{
+	// Parsing the disc image (especially a CHD's header) can take a while, so the reader is opened here too.
+	try
+	{
+		result.cd_stream = std::make_unique<DiscPreloader>(std::move(result.file));
+
+		// This must be done first, so that the reader opens a cue sheet's track files through the preloader.
+		if (preload_cd)
+			result.cd_stream->StartPreloading(path);
+
+		result.cd_reader = std::make_unique<CDReader>(path, result.cd_stream->GetStream());
+	}
+	catch (const std::bad_alloc&)
+	{
+		return false;
+	}
+
+	if (!result.cd_reader->IsOpen())
+		return false;
+
+	result.cd_digests = result.cd_reader->HashDataTrack();
+	result.cd_image_size = CDReader::GetImageSize(path);
+
+	// Hand the reader over at the start of the disc, as if it had not been used.
+	result.cd_reader->SeekToSector(0);
+
+	return true;
+}
+
+void SoftwareLoader::Load()
+{
+	// This opens the file if needed, and works out what it is, all in one go.
+	auto probe = SoftwareProbe::Probe(path, std::move(file), type == Type::UNKNOWN ? validate_save_state : nullptr);
+
+	if (probe.has_value() && !cancelled)
+	{
+		file = std::move(probe->file);
+		total_bytes = std::max<Sint64>(0, probe->descriptor.size);
+
+		if (type == Type::UNKNOWN)
+			type = probe->descriptor.type;
+
+		Result loaded{type, path, nullptr, {}, nullptr, nullptr, std::nullopt, 0};
+		bool success = true;
+
+		if (type == Type::CARTRIDGE)
+		{
+			auto loaded_cartridge_buffer = LoadCartridge();
+
+			if (loaded_cartridge_buffer.has_value())
+				loaded.cartridge_buffer = std::move(*loaded_cartridge_buffer);
+			else
+				success = false;
+		}
+
+		loaded.file = std::move(file);
+
+		if (type == Type::CD)
+			success = OpenCD(loaded);
+
+		if (success)
+			result = std::move(loaded);
+	}
+
+	finished = true;
+}
+
+SoftwareLoader::SoftwareLoader(const std::filesystem::path &path, SDL::IOStream &&file, const Type type, const SaveStateValidator &validate_save_state, const bool preload_cd)
+	: path(path)
+	, file(std::move(file))
+	, type(type)
+	, validate_save_state(validate_save_state)
+	, preload_cd(preload_cd)
+{
+	try
+	{
+		thread = std::thread([this]()
+			{
+				// The CD reader's error callback is not thread-safe.
+				CDReader::errors_silenced = true;
+				Load();
+			}
+		);
+	}
+	catch (const std::system_error&)
+	{
+		// Threads are unavailable, so just load the file here instead.
+		Load();
+	}
+}
+
+SoftwareLoader::~SoftwareLoader()
+{
+	cancelled = true;
+
+	if (thread.joinable())
+		thread.join();
+}
+
+float SoftwareLoader::GetProgress() const
+{
+	if (total_bytes == 0)
+		return 0.0f;
+
+	return static_cast<float>(bytes_loaded) / total_bytes;
+}
+
+std::optional<SoftwareLoader::Result> SoftwareLoader::TakeResult()
+{
+	if (thread.joinable())
+		thread.join();
+
+	return std::move(result);
+}
@@ -0,0 +1,78 @@
+#ifndef SOFTWARE_LOADER_H
+#define SOFTWARE_LOADER_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "../common/core/libraries/clowncommon/clowncommon.h"
+
+#include "cd-reader.h"
+#include "disc-preloader.h"
+#include "sdl-wrapper.h"
+#include "software-probe.h"
+
+// Identifies and reads software on a worker thread, so that large, compressed, or slow files do not freeze the window.
+// Nothing is given to the emulator here: the finished result is collected on the main thread, so the current game
+// keeps running until then.
+class SoftwareLoader
+{
+public:
+	using Type = SoftwareProbe::Type;
+
+	struct Result
+	{
+		Type type;
+		std::filesystem::path path;
+		SDL::IOStream file;
+		std::vector<cc_u16l> cartridge_buffer;
+		// For CDs, 'file' is moved into 'cd_stream', and 'cd_reader' is already open on it.
+		std::unique_ptr<DiscPreloader> cd_stream;
+		std::unique_ptr<CDReader> cd_reader;
+		// The disc is identified here too, while a reader is open on this thread, so that it is known before the first frame.
+		std::optional<Hash::Digests> cd_digests;
+		std::uintmax_t cd_image_size;
+	};
+
+	using SaveStateValidator = SoftwareProbe::SaveStateValidator;
+
+private:
+	std::filesystem::path path;
+	SDL::IOStream file;
+	Type type;
+	SaveStateValidator validate_save_state;
+	bool preload_cd;
+
+	std::thread thread;
+	std::atomic<Sint64> bytes_loaded = 0;
+	std::atomic<Sint64> total_bytes = 0;
+	std::atomic<bool> finished = false;
+	std::atomic<bool> cancelled = false;
+	std::optional<Result> result;
+
+	std::optional<std::vector<cc_u16l>> LoadCartridge();
+	bool OpenCD(Result &result);
+	void Load();
+
+public:
+	// If 'file' is null, then it is opened from 'path' on the worker thread.
+	// If 'preload_cd' is true, then CDs start being copied into RAM before the CD reader is opened.
+	SoftwareLoader(const std::filesystem::path &path, SDL::IOStream &&file, Type type, const SaveStateValidator &validate_save_state = nullptr, bool preload_cd = false);
+	~SoftwareLoader();
+	SoftwareLoader(const SoftwareLoader &other) = delete;
+	SoftwareLoader(SoftwareLoader &&other) = delete;
+	SoftwareLoader& operator=(const SoftwareLoader &other) = delete;
+	SoftwareLoader& operator=(SoftwareLoader &&other) = delete;
+
+	[[nodiscard]] bool IsFinished() const { return finished; }
+	[[nodiscard]] float GetProgress() const;
+	// Must only be called once 'IsFinished' returns true. Returns nothing if the file could not be loaded.
+	[[nodiscard]] std::optional<Result> TakeResult();
+};
+
+#endif /* SOFTWARE_LOADER_H */
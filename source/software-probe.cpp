@@ -0,0 +1,86 @@
+#include "software-probe.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "cd-reader.h"
+
+SoftwareProbe::Descriptor SoftwareProbe::Identify(const std::filesystem::path &path, SDL::IOStream &file, const SaveStateValidator &validate_save_state)
+{
+	Descriptor descriptor;
+	descriptor.size = SDL_GetIOSize(file);
+
+	// This covers the cartridge header, and the disc header of both 2048-byte and 2352-byte sector images.
+	std::array<unsigned char, 0x200> header{};
+	const auto header_size = SDL_ReadIO(file, std::data(header), std::size(header));
+	SDL_SeekIO(file, 0, SDL_IO_SEEK_SET);
+
+	const auto &HasSignature = [&](const std::size_t offset, const std::string_view &signature)
+	{
+		return offset + std::size(signature) <= header_size && std::equal(std::begin(signature), std::end(signature), std::begin(header) + offset);
+	};
+
+	auto extension = path.extension().string();
+	std::transform(std::begin(extension), std::end(extension), std::begin(extension), [](const unsigned char character) { return std::tolower(character); });
+
+	// The common cases are recognised from the header alone.
+	// The disc header is at the start of 2048-byte sector images, and after the sync bytes and sector header of 2352-byte ones.
+	if (HasSignature(0, "MComprHD") || extension == ".cue" || HasSignature(0, "SEGADISCSYSTEM") || HasSignature(0x10, "SEGADISCSYSTEM"))
+		descriptor.type = Type::CD;
+	else if (HasSignature(0, "PK\x03\x04"))
+		descriptor.type = Type::CARTRIDGE;
+	else if (validate_save_state != nullptr && validate_save_state(file))
+		descriptor.type = Type::SAVE_STATE;
+	else if (HasSignature(0x100, "SEGA"))
+		descriptor.type = Type::CARTRIDGE;
+	// Anything else is left to the CD reader, which knows every disc format that it supports, such as audio-only discs.
+	else if (CDReader::IsDefinitelyACD(path))
+		descriptor.type = Type::CD;
+	else
+		descriptor.type = Type::CARTRIDGE;
+
+	return descriptor;
+}
+
+std::optional<SoftwareProbe::Result> SoftwareProbe::Probe(const std::filesystem::path &path, SDL::IOStream &&file, const SaveStateValidator &validate_save_state)
+{
+	Result result{{}, file ? std::move(file) : SDL::IOStream(path, "rb")};
+
+	if (!result.file)
+		return std::nullopt;
+
+	// Streams which do not come from the file system (such as browser uploads) cannot be cached.
+	std::error_code error;
+	const auto modification_time = std::filesystem::last_write_time(path, error);
+
+	if (!error)
+	{
+		const std::lock_guard lock(cache_mutex);
+
+		const auto &entry = cache.find(path);
+
+		if (entry != std::end(cache) && entry->second.modification_time == modification_time && (entry->second.checked_for_save_state || validate_save_state == nullptr))
+		{
+			result.descriptor = entry->second.descriptor;
+			return result;
+		}
+	}
+
+	result.descriptor = Identify(path, result.file, validate_save_state);
+
+	if (!error)
+	{
+		const std::lock_guard lock(cache_mutex);
+
+		if (std::size(cache) >= maximum_cache_entries)
+			cache.clear();
+
+		cache.insert_or_assign(path, CacheEntry{modification_time, validate_save_state != nullptr, result.descriptor});
+	}
+
+	return result;
+}
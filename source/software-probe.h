@@ -0,0 +1,62 @@
+#ifndef SOFTWARE_PROBE_H
+#define SOFTWARE_PROBE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+
+#include "sdl-wrapper.h"
+
+// Works out what a file is from its first few bytes, so that it only needs to be opened once.
+// Results are cached by path and modification time, so probing a file again costs only a 'stat'.
+class SoftwareProbe
+{
+public:
+	enum class Type
+	{
+		UNKNOWN, // Work it out from the file's contents.
+		CARTRIDGE,
+		CD,
+		SAVE_STATE,
+	};
+
+	struct Descriptor
+	{
+		Type type = Type::UNKNOWN;
+		Sint64 size = 0;
+	};
+
+	struct Result
+	{
+		Descriptor descriptor;
+		SDL::IOStream file;
+	};
+
+	using SaveStateValidator = std::function<bool(SDL::IOStream &file)>;
+
+private:
+	struct CacheEntry
+	{
+		std::filesystem::file_time_type modification_time;
+		bool checked_for_save_state;
+		Descriptor descriptor;
+	};
+
+	// Library scans can probe a great many files, so the cache is emptied whenever it grows past this.
+	static constexpr std::size_t maximum_cache_entries = 0x1000;
+
+	static inline std::mutex cache_mutex;
+	static inline std::map<std::filesystem::path, CacheEntry> cache;
+
+	static Descriptor Identify(const std::filesystem::path &path, SDL::IOStream &file, const SaveStateValidator &validate_save_state);
+
+public:
+	// If 'file' is null, then it is opened from 'path'. The returned stream is positioned at the start of the file.
+	// Save states are only detected if 'validate_save_state' is given.
+	static std::optional<Result> Probe(const std::filesystem::path &path, SDL::IOStream &&file = nullptr, const SaveStateValidator &validate_save_state = nullptr);
+};
+
+#endif /* SOFTWARE_PROBE_H */
@@ -0,0 +1,49 @@
+#include "startup-report.h"
+
+#include <string_view>
+
+#include <fmt/format.h>
+
+void StartupReport::Enable()
+{
+	enabled = true;
+	phase_start_time = SDL_GetTicksNS();
+}
+
+void StartupReport::EndPhase(const char* const name)
+{
+	if (!enabled)
+		return;
+
+	const auto current_time = SDL_GetTicksNS();
+	phases.emplace_back(name, current_time - phase_start_time);
+	phase_start_time = current_time;
+}
+
+void StartupReport::Print()
+{
+	if (!enabled)
+		return;
+
+	enabled = false;
+
+	const auto &FormatLine = [](const std::string_view &name, const Uint64 duration)
+	{
+		return fmt::format("  {:<24}{:>9.2f}ms\n", name, static_cast<double>(duration) / SDL_NS_PER_MS);
+	};
+
+	std::string report = "Start-up report:\n";
+	Uint64 total_duration = 0;
+
+	for (const auto &[name, duration] : phases)
+	{
+		report += FormatLine(name, duration);
+		total_duration += duration;
+	}
+
+	report += FormatLine("Total", total_duration);
+
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s", report.c_str());
+
+	phases.clear();
+}
@@ -0,0 +1,24 @@
+#ifndef STARTUP_REPORT_H
+#define STARTUP_REPORT_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <SDL3/SDL.h>
+
+// Times each phase of start-up, so that they can be printed with the '--startup-report' flag.
+class StartupReport
+{
+private:
+	static inline bool enabled;
+	static inline Uint64 phase_start_time;
+	static inline std::vector<std::pair<std::string, Uint64>> phases;
+
+public:
+	static void Enable();
+	static void EndPhase(const char *name);
+	static void Print();
+};
+
+#endif /* STARTUP_REPORT_H */
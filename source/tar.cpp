@@ -4,7 +4,44 @@
 
 #include "file-utilities.h"
 
-TarBall::TarBall(const DataSpan &input_buffer, const std::size_t uncompressed_size, const Compression compression)
+void TarBall::IndexFiles(const DataSpan &available_data)
+{
+	const auto &ReadOctal = [&](const std::size_t offset, const std::size_t length)
+	{
+		const auto &span = available_data.subspan(offset, length);
+		const auto &start = reinterpret_cast<const char*>(span.begin());
+		const auto &end = reinterpret_cast<const char*>(span.end());
+		return FileUtilities::StringToInteger<std::size_t>(std::string_view(start, end), 8);
+	};
+
+	// Only index files which are complete, so that this can be called repeatedly as the archive is decompressed.
+	while (indexed_size + block_size <= std::size(available_data))
+	{
+		const auto offset = indexed_size;
+		const auto file_size = ReadOctal(offset + 124, 11);
+
+		// The archive ends with empty blocks, which do not have a valid size.
+		if (!file_size.has_value())
+		{
+			indexed_size = std::size(available_data);
+			return;
+		}
+
+		const auto padded_file_size = CC_DIVIDE_CEILING(*file_size, block_size) * block_size;
+
+		if (offset + block_size + padded_file_size > std::size(available_data))
+			return;
+
+		const std::u8string_view file_path_string(reinterpret_cast<const char8_t*>(available_data.begin() + offset), 100);
+		const std::filesystem::path file_path(file_path_string.substr(0, file_path_string.find_first_of('\0'))); // Remove trailing null characters.
+
+		files.emplace(file_path, available_data.subspan(offset + block_size, *file_size));
+
+		indexed_size = offset + block_size + padded_file_size;
+	}
+}
+
+TarBall::TarBall(const DataSpan &input_buffer, const std::size_t uncompressed_size, const Compression compression, const std::filesystem::path &needed_file)
 {
 	switch (compression)
 	{
@@ -13,42 +50,40 @@ TarBall::TarBall(const DataSpan &input_buffer, const std::size_t uncompressed_si
 			break;
 
 		case Compression::LZMA:
-			auto decompressed_input_buffer = FileUtilities::DecompressLZMABuffer(std::data(input_buffer), std::size(input_buffer), uncompressed_size);
+			FileUtilities::DecompressionProgressCallback progress_callback;
+
+			if (!needed_file.empty())
+			{
+				progress_callback = [&](const unsigned char* const data, const std::size_t data_size)
+				{
+					IndexFiles({data, data_size});
+					return files.contains(needed_file);
+				};
+			}
+
+			auto decompressed_input_buffer = FileUtilities::DecompressLZMABuffer(std::data(input_buffer), std::size(input_buffer), uncompressed_size, progress_callback);
 
 			if (!decompressed_input_buffer.has_value())
+			{
+				files.clear();
 				return;
+			}
 
+			// Moving the vector does not move its contents, so the spans in the index remain valid.
 			decompressed_buffer = std::move(*decompressed_input_buffer);
 			buffer = decompressed_buffer;
 			break;
 	}
+
+	IndexFiles(buffer);
 }
 
 std::optional<TarBall::DataSpan> TarBall::OpenFile(const std::filesystem::path &path) const
 {
-	const auto &ReadOctal = [&](const std::size_t offset, const std::size_t length)
-	{
-		const auto &span = buffer.subspan(offset, length);
-		const auto &start = reinterpret_cast<const char*>(span.begin());
-		const auto &end = reinterpret_cast<const char*>(span.end());
-		return FileUtilities::StringToInteger<std::size_t>(std::string_view(start, end), 8);
-	};
+	const auto &file = files.find(path);
 
-	for (std::size_t offset = 0; offset < std::size(buffer); offset += block_size)
-	{
-		const auto file_size = ReadOctal(offset + 124, 11);
-
-		if (!file_size.has_value())
-			return std::nullopt;
-
-		const std::u8string_view file_path_string(reinterpret_cast<const char8_t*>(buffer.begin() + offset), 100);
-		const std::filesystem::path file_path(file_path_string.substr(0, file_path_string.find_first_of('\0'))); // Remove trailing null characters.
-
-		if (path == file_path)
-			return buffer.subspan(offset + block_size, *file_size);
-
-		offset += CC_DIVIDE_CEILING(*file_size, block_size) * block_size;
-	}
+	if (file == files.end())
+		return std::nullopt;
 
-	return std::nullopt;
+	return file->second;
 }
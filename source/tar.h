@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <map>
 #include <optional>
 #include <vector>
 
@@ -10,12 +11,6 @@
 
 class TarBall
 {
-private:
-	static constexpr std::size_t block_size = 0x200;
-
-	std::vector<unsigned char> decompressed_buffer;
-	tcb::span<const unsigned char> buffer;
-
 public:
 	using DataSpan = tcb::span<const unsigned char>;
 
@@ -25,7 +20,20 @@ public:
 		LZMA,
 	};
 
-	TarBall(const DataSpan &input_buffer, std::size_t uncompressed_size = 0, Compression compression = Compression::None);
+private:
+	static constexpr std::size_t block_size = 0x200;
+
+	std::vector<unsigned char> decompressed_buffer;
+	tcb::span<const unsigned char> buffer;
+	std::map<std::filesystem::path, DataSpan> files;
+	std::size_t indexed_size = 0;
+
+	void IndexFiles(const DataSpan &available_data);
+
+public:
+	// If 'needed_file' is given, then decompression stops as soon as that file has been extracted,
+	// so any files after it in the archive cannot be opened.
+	TarBall(const DataSpan &input_buffer, std::size_t uncompressed_size = 0, Compression compression = Compression::None, const std::filesystem::path &needed_file = {});
 
 	std::optional<DataSpan> OpenFile(const std::filesystem::path &path) const;
 };
@@ -1,6 +1,7 @@
 #include "text-encoding.h"
 
 #include <array>
+#include <cstddef>
 
 static const std::array<cc_u16l, 0x3100> shiftjis_to_unicode_lookup = {
 	0x0000, 0x0001, 0x0002, 0x0003, 0x0004, 0x0005, 0x0006, 0x0007, 0x0008, 0x0009, 0x000A, 0x000B, 0x000C, 0x000D, 0x000E, 0x000F,
@@ -854,3 +855,48 @@ std::optional<std::string> UTF32ToUTF8(const cc_u32f utf32_codepoint)
 
 	return utf8;
 }
+
+std::string DecodeHeaderName(const unsigned char* const in_buffer, const std::size_t in_buffer_size)
+{
+	std::string name_buffer;
+	// '*4' for the maximum UTF-8 length.
+	name_buffer.reserve(in_buffer_size * 4);
+
+	cc_u32f previous_codepoint = '\0';
+
+	// In Columns, both regions' names are encoded in SHIFT-JIS, so both names are decoded as SHIFT-JIS here.
+	// A two-byte character which straddles the end of the name is invalid.
+	for (std::size_t in_index = 0; in_index < in_buffer_size; )
+	{
+		cc_u8f in_bytes_read;
+		const cc_u32f codepoint = ShiftJISToUTF32(&in_buffer[in_index], &in_bytes_read);
+
+		if (in_index + in_bytes_read > in_buffer_size)
+			return {};
+
+		in_index += in_bytes_read;
+
+		// Null characters are obviously invalid.
+		if (codepoint == '\0')
+			return {};
+
+		// Eliminate padding (the Sonic games tend to use padding to make the name look good in a hex editor).
+		if (codepoint != ' ' || previous_codepoint != ' ')
+		{
+			const auto utf8_codepoint = UTF32ToUTF8(codepoint);
+
+			if (!utf8_codepoint.has_value())
+				return {};
+
+			name_buffer += *utf8_codepoint;
+		}
+
+		previous_codepoint = codepoint;
+	}
+
+	// Eliminate trailing space.
+	if (!name_buffer.empty() && name_buffer.back() == ' ')
+		name_buffer.pop_back();
+
+	return name_buffer;
+}
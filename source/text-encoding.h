@@ -1,6 +1,7 @@
 #ifndef TEXT_ENCODING_H
 #define TEXT_ENCODING_H
 
+#include <cstddef>
 #include <optional>
 #include <string>
 
@@ -13,4 +14,8 @@ cc_u16l ShiftJISToUTF32(const unsigned char* const in_buffer, cc_u8f* const byte
 /* Returns number of bytes written (maximum 4). */
 std::optional<std::string> UTF32ToUTF8(const cc_u32f utf32_codepoint);
 
+/* Decodes a SHIFT-JIS name from a cartridge or disc header, removing its padding. */
+/* Returns an empty string if the name is invalid. */
+std::string DecodeHeaderName(const unsigned char* const in_buffer, const std::size_t in_buffer_size);
+
 #endif /* TEXT_ENCODING_H */
@@ -1,6 +1,9 @@
 #ifndef WINDOW_POPUP_H
 #define WINDOW_POPUP_H
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <functional>
 #include <optional>
 #include <string>
@@ -10,15 +13,66 @@
 
 #include "window-with-dear-imgui.h"
 
+// Settings which are shared by every pop-up window, regardless of its type.
+class WindowPopupRefresh
+{
+public:
+	enum class Rate
+	{
+		LIVE,
+		HZ_30,
+		HZ_10,
+		HZ_1,
+		ON_PAUSE
+	};
+
+	static constexpr std::array<const char*, 5> rate_names = {
+		"Live",
+		"30Hz",
+		"10Hz",
+		"1Hz",
+		"On Pause",
+	};
+
+	// The refresh rate that newly-opened windows start with.
+	static inline Rate default_rate = Rate::LIVE;
+	// Set by the frontend each frame, so that 'ON_PAUSE' windows know when to redraw.
+	static inline bool emulator_paused;
+
+	static Uint64 GetIntervalNS(const Rate rate)
+	{
+		switch (rate)
+		{
+			case Rate::HZ_30:
+				return SDL_NS_PER_SECOND / 30;
+			case Rate::HZ_10:
+				return SDL_NS_PER_SECOND / 10;
+			case Rate::HZ_1:
+				return SDL_NS_PER_SECOND;
+			case Rate::LIVE:
+			case Rate::ON_PAUSE:
+				break;
+		}
+
+		return 0;
+	}
+};
+
 template<typename Derived>
 class WindowPopup
 {
 private:
+	// Dear ImGui needs a few frames to settle after input or a resize, so keep redrawing for this many frames.
+	static constexpr unsigned int redraws_after_event = 3;
+
 	std::optional<WindowWithDearImGui> window;
 	std::string title;
 	bool resizeable;
 	WindowWithDearImGui *host_window;
 	std::pair<int, int> size;
+	WindowPopupRefresh::Rate refresh_rate = WindowPopupRefresh::default_rate;
+	Uint64 last_redraw_time = 0;
+	unsigned int forced_redraws = redraws_after_event;
 
 	bool UsesChildWindow() const
 	{
@@ -61,6 +115,66 @@ private:
 		return true;
 	}
 
+	bool IsRedrawDue()
+	{
+		// Dear ImGui windows are part of the main window's frame, so they must always be drawn.
+		if (!window.has_value())
+			return true;
+
+		const auto now = SDL_GetTicksNS();
+
+		if (forced_redraws != 0)
+		{
+			--forced_redraws;
+		}
+		else
+		{
+			switch (refresh_rate)
+			{
+				case WindowPopupRefresh::Rate::LIVE:
+					break;
+
+				case WindowPopupRefresh::Rate::ON_PAUSE:
+					if (!WindowPopupRefresh::emulator_paused)
+						return false;
+					break;
+
+				default:
+					if (now - last_redraw_time < WindowPopupRefresh::GetIntervalNS(refresh_rate))
+						return false;
+					break;
+			}
+		}
+
+		last_redraw_time = now;
+		return true;
+	}
+
+	void DisplayRefreshRateMenu()
+	{
+		if (!window.has_value())
+			return;
+
+		if (ImGui::BeginPopupContextWindow("##Refresh Rate", ImGuiPopupFlags_MouseButtonRight | ImGuiPopupFlags_NoOpenOverItems))
+		{
+			ImGui::SeparatorText("Refresh Rate");
+
+			for (std::size_t i = 0; i < std::size(WindowPopupRefresh::rate_names); ++i)
+			{
+				const auto rate = static_cast<WindowPopupRefresh::Rate>(i);
+
+				if (ImGui::MenuItem(WindowPopupRefresh::rate_names[i], nullptr, refresh_rate == rate))
+					refresh_rate = rate;
+			}
+
+			ImGui::EndPopup();
+		}
+
+		// Keep menus, combo boxes, and tooltips responsive even when the window is throttled.
+		if (ImGui::IsPopupOpen("", ImGuiPopupFlags_AnyPopupId | ImGuiPopupFlags_AnyPopupLevel))
+			forced_redraws = std::max(forced_redraws, 1u);
+	}
+
 	void End()
 	{
 		if (UsesChildWindow())
@@ -151,6 +265,9 @@ public:
 			window.emplace(window_title, width, height, resizeable, dpi_scale);
 			SDL_SetWindowParent(window->GetSDLWindow(), parent_window.GetSDLWindow());
 
+			// Waiting for V-Sync here would stall the main window, and therefore the emulator, so only the main window may do it.
+			window->SetVSync(false);
+
 			// We don't want to show the window before its size is correctly set in the `End` method.
 			if (resizeable)
 				SDL_ShowWindow(window->GetSDLWindow());
@@ -168,8 +285,15 @@ public:
 
 		bool alive = true;
 
+		// Skip the whole frame, including presenting it, if this window is being throttled.
+		if (!IsRedrawDue())
+			return alive;
+
 		if (Begin(&alive, derived->window_flags))
+		{
 			derived->DisplayInternal(std::forward<Ts>(arguments)...);
+			DisplayRefreshRateMenu();
+		}
 
 		End();
 
@@ -192,6 +316,9 @@ public:
 		ImGui_ImplSDL3_ProcessEvent(&event);
 
 		ImGui::SetCurrentContext(previous_context);
+
+		// Redraw promptly so that input is not held back by the refresh rate.
+		forced_redraws = redraws_after_event;
 	}
 
 	WindowWithDearImGui& GetWindow()
@@ -1,10 +1,15 @@
 #include "window-with-dear-imgui.h"
 
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "../../file-utilities.h"
+#include "../../frontend.h"
+#include "../../save-data-writer.h"
 #include "../../sdl-wrapper-extra.h"
 #include "../../tar.h"
+#include "../../version.h"
 
 namespace CompressedFonts
 {
@@ -17,6 +22,49 @@ namespace CompressedFonts
 
 static constexpr float UNSCALED_FONT_SIZE = 16.0f;
 
+static std::string GetFontCacheKey()
+{
+	// The cache is keyed on the build and the archive's sizes, so that a build with different fonts never uses a stale cache.
+	// Unlike hashing the archive, this costs nothing at start-up.
+	return fmt::format("ClownMDEmu " VERSION " fonts {} {}\n", std::size(CompressedFonts::buffer), CompressedFonts::uncompressed_size);
+}
+
+// Decompressing the font archive is one of the slowest parts of starting up,
+// so the decompressed archive is cached in the configuration directory.
+static std::vector<unsigned char> LoadFontArchive()
+{
+	const auto cache_path = Frontend::GetConfigurationDirectoryPath() / "font-cache.bin";
+	const auto key = GetFontCacheKey();
+
+	if (FileUtilities::FileExists(cache_path))
+	{
+		SDL::IOStream file(cache_path, "rb");
+
+		if (file && SDL_GetIOSize(file) == static_cast<Sint64>(std::size(key) + CompressedFonts::uncompressed_size))
+		{
+			std::string cached_key(std::size(key), '\0');
+			std::vector<unsigned char> buffer(CompressedFonts::uncompressed_size);
+
+			if (SDL_ReadIO(file, std::data(cached_key), std::size(cached_key)) == std::size(cached_key) && cached_key == key && SDL_ReadIO(file, std::data(buffer), std::size(buffer)) == std::size(buffer))
+				return buffer;
+		}
+	}
+
+	auto buffer = FileUtilities::DecompressLZMABuffer(std::data(CompressedFonts::buffer), std::size(CompressedFonts::buffer), CompressedFonts::uncompressed_size);
+
+	if (!buffer.has_value())
+		return {};
+
+	// The cache is replaced atomically, so that an interrupted write cannot leave a truncated cache behind.
+	std::vector<unsigned char> cache(std::begin(key), std::end(key));
+	cache.insert(std::end(cache), std::begin(*buffer), std::end(*buffer));
+
+	if (!SaveDataWriter::WriteFileAtomically(cache_path, std::data(cache), std::size(cache)))
+		debug_log.Log("Could not write font cache to '{}'", cache_path.string());
+
+	return std::move(*buffer);
+}
+
 float WindowWithDearImGui::GetFontScale()
 {
 	return CalculateFontSize() / UNSCALED_FONT_SIZE;
@@ -28,9 +76,12 @@ unsigned int WindowWithDearImGui::CalculateFontSize()
 	return static_cast<unsigned int>(UNSCALED_FONT_SIZE * dpi_scale);
 }
 
-void WindowWithDearImGui::ReloadFonts(const unsigned int font_size)
+void WindowWithDearImGui::ReloadFonts()
 {
-	static auto fonts = TarBall(CompressedFonts::buffer, CompressedFonts::uncompressed_size, TarBall::Compression::LZMA);
+	// This is shared by every window, and the atlases only reference it rather than copy it,
+	// so each window only pays for the glyphs that it actually rasterises.
+	static const auto font_archive = LoadFontArchive();
+	static const auto fonts = TarBall(font_archive);
 
 	ImGuiIO &io = ImGui::GetIO();
 
@@ -143,6 +194,7 @@ WindowWithDearImGui::WindowWithDearImGui(const char* const window_title, const f
 	: Window(window_title, window_width, window_height, resizeable, forced_scale, window_flags)
 	, dear_imgui_context(ImGui::CreateContext())
 	, dpi_scale(GetDPIScale())
+	, font_size(CalculateFontSize())
 {
 	const auto &previous_context = ImGui::GetCurrentContext();
 	ImGui::SetCurrentContext(dear_imgui_context);
@@ -207,7 +259,7 @@ WindowWithDearImGui::WindowWithDearImGui(const char* const window_title, const f
 	ImGui_ImplSDLRenderer3_Init(GetRenderer());
 
 	// Load fonts
-	ReloadFonts(CalculateFontSize());
+	ReloadFonts();
 
 	ImGui::SetCurrentContext(previous_context);
 }
@@ -228,6 +280,8 @@ void WindowWithDearImGui::StartDearImGuiFrame()
 	previous_dear_imgui_context = ImGui::GetCurrentContext();
 	ImGui::SetCurrentContext(dear_imgui_context);
 
+	ApplyIcon();
+
 	// Handle dynamic DPI support
 	const float new_dpi = GetDPIScale();
 
@@ -238,7 +292,16 @@ void WindowWithDearImGui::StartDearImGuiFrame()
 		auto& style = ImGui::GetStyle();
 		style = style_backup;
 		style.ScaleAllSizes(dpi_scale);
-		ReloadFonts(CalculateFontSize());
+
+		// The font size is floored, so small DPI changes often leave it the same.
+		// Rebuilding the atlas throws away every glyph that has been rasterised so far, so avoid it when possible.
+		const auto new_font_size = CalculateFontSize();
+
+		if (font_size != new_font_size)
+		{
+			font_size = new_font_size;
+			ReloadFonts();
+		}
 	}
 
 	// Start the Dear ImGui frame
@@ -65,10 +65,11 @@ private:
 	ImGuiContext *previous_dear_imgui_context;
 	ImGuiStyle style_backup;
 	float dpi_scale;
+	unsigned int font_size;
 
 	float GetFontScale();
 	unsigned int CalculateFontSize();
-	void ReloadFonts(unsigned int font_size);
+	void ReloadFonts();
 
 public:
 	static auto FloatColourChannelToU8(const float colour) { return static_cast<unsigned char>(colour * 0xFF + 0.5f); };
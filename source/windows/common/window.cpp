@@ -1,7 +1,10 @@
 #include "window.h"
 
 #include <algorithm>
+#include <chrono>
+#include <future>
 #include <stdexcept>
+#include <system_error>
 
 #include "../../common/core/libraries/clowncommon/clowncommon.h"
 
@@ -37,7 +40,45 @@ static SDL::Surface LoadWindowIcon()
 
 	return surface;
 }
+
+// Decoding the icons is slow, so it is done on another thread while the rest of the program starts up.
+static std::shared_future<SDL::Surface> window_icon;
+#endif
+
+void Window::StartLoadingIcon()
+{
+#ifndef SDL_PLATFORM_WIN32
+	if (window_icon.valid())
+		return;
+
+	try
+	{
+		window_icon = std::async(std::launch::async, LoadWindowIcon).share();
+	}
+	catch (const std::system_error&)
+	{
+		// Threads are unavailable, so just decode the icons here instead.
+		std::promise<SDL::Surface> promise;
+		promise.set_value(LoadWindowIcon());
+		window_icon = promise.get_future().share();
+	}
 #endif
+}
+
+void Window::ApplyIcon()
+{
+#ifndef SDL_PLATFORM_WIN32
+	if (!icon_pending)
+		return;
+
+	// Don't hold up the window; try again next frame.
+	if (window_icon.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return;
+
+	SDL_SetWindowIcon(sdl_window, window_icon.get());
+	icon_pending = false;
+#endif
+}
 
 static float HandleDPIError(const float dpi_scale)
 {
@@ -112,8 +153,9 @@ Window::Window(const char* const window_title, const float window_width, const f
 	ApplyState();
 
 #ifndef SDL_PLATFORM_WIN32
-	static SDL::Surface window_icon = LoadWindowIcon();
-	SDL_SetWindowIcon(window, window_icon);
+	StartLoadingIcon();
+	icon_pending = true;
+	ApplyIcon();
 #endif
 }
 
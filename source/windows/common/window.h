@@ -13,6 +13,7 @@ class Window
 private:
 	SDL::Window sdl_window;
 	SDL::Renderer renderer;
+	bool icon_pending = false;
 
 public:
 	struct State
@@ -30,6 +31,8 @@ public:
 	Window(const char *window_title, float window_width, float window_height, bool resizeable, const std::optional<float> &forced_scale = std::nullopt, SDL_WindowFlags window_flags = 0);
 
 	static float GetDisplayDPIScale();
+	static void StartLoadingIcon();
+	void ApplyIcon();
 	float GetSizeScale();
 	float GetDPIScale();
 	void SetFullscreen(bool enabled);
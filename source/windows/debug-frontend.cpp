@@ -1,5 +1,8 @@
 #include "debug-frontend.h"
 
+#include <chrono>
+#include <optional>
+
 #include "../frontend.h"
 
 void DebugFrontend::DisplayInternal()
@@ -100,6 +103,165 @@ void DebugFrontend::DisplayInternal()
 		ImGui::EndTable();
 	}
 
+	ImGui::SeparatorText("Frame Pacing");
+
+	if (ImGui::BeginTable("Frame Pacing", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+	{
+		const auto &frame_pacer = frontend->frame_pacer;
+
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted("Synchronised to Display");
+		DoToolTip("Whether one frame is being run per display refresh.");
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted(frame_pacer.IsDisplaySynced() ? "Yes" : "No");
+
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted("Measured Refresh Rate");
+		DoToolTip("The display's refresh rate, as measured from\nthe time between frames being presented.");
+		ImGui::TableNextColumn();
+		const auto &refresh_rate = frame_pacer.GetMeasuredRefreshRate();
+		if (refresh_rate.has_value())
+			ImGui::TextFormatted("{:.3f}Hz", *refresh_rate);
+		else
+			ImGui::TextUnformatted("N/A");
+
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted("Frame Cost (P99)");
+		DoToolTip("How long the slowest 1% of recent frames took\nto emulate and draw, not counting presentation.");
+		ImGui::TableNextColumn();
+		ImGui::TextFormatted("{:.2f}ms", frame_pacer.GetFrameCostP99());
+
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted("Latency Saved");
+		DoToolTip("The average frame delay: how much later input\nis read, and so how much sooner it is shown.");
+		ImGui::TableNextColumn();
+		const auto &frame_delay = frame_pacer.GetFrameDelayStatistics();
+		if (!frame_pacer.IsFrameDelayActive() || frame_delay.IsEmpty())
+			ImGui::TextUnformatted("N/A");
+		else
+			ImGui::TextFormatted("{:.2f}ms (margin {:.2f}ms)", frame_delay.GetMean(), frame_pacer.GetFrameDelayMargin());
+
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted("Missed Refreshes");
+		DoToolTip("How many frames were delayed for too long,\nand so were shown a refresh late.");
+		ImGui::TableNextColumn();
+		ImGui::TextFormatted("{}", frame_pacer.GetMissedRefreshes());
+
+		ImGui::EndTable();
+	}
+
+	ImGui::SeparatorText("Frame Pacing Metrics");
+	DoToolTip("The mean and standard deviation of the time between frames, and of the\nnumber of audio frames that are queued when a frame starts, for each\nframe pacing mode. Switch modes to compare them.");
+
+	if (ImGui::BeginTable("Frame Pacing Metrics", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+	{
+		const auto &DoMetrics = [&](const char* const label, const FramePacer::Mode mode)
+		{
+			const auto &metrics = frontend->frame_pacer.GetMetrics(mode);
+
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(label);
+
+			ImGui::TableNextColumn();
+			if (metrics.frame_interval.IsEmpty())
+				ImGui::TextUnformatted("N/A");
+			else
+				ImGui::TextFormatted("{:.2f}ms +/- {:.2f}ms", metrics.frame_interval.GetMean(), metrics.frame_interval.GetStandardDeviation());
+
+			ImGui::TableNextColumn();
+			if (metrics.audio_queue_depth.IsEmpty())
+				ImGui::TextUnformatted("N/A");
+			else
+				ImGui::TextFormatted("{:.0f} +/- {:.0f}", metrics.audio_queue_depth.GetMean(), metrics.audio_queue_depth.GetStandardDeviation());
+		};
+
+		ImGui::TableSetupColumn("Mode");
+		ImGui::TableSetupColumn("Frame Interval");
+		ImGui::TableSetupColumn("Audio Queue Depth");
+		ImGui::TableHeadersRow();
+
+		DoMetrics("Timer", FramePacer::Mode::TIMER);
+		DoMetrics("Display", FramePacer::Mode::DISPLAY);
+		DoMetrics("Audio", FramePacer::Mode::AUDIO);
+
+		ImGui::EndTable();
+	}
+
+	if (ImGui::Button("Clear Metrics"))
+		frontend->frame_pacer.ClearMetrics();
+
+	ImGui::SeparatorText("CHD Cache");
+
+	if (ImGui::BeginTable("CHD Cache", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+	{
+		const auto &statistics = frontend->emulator->GetCDHunkCacheStatistics();
+		const auto total_reads = statistics.hits + statistics.misses;
+
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted("Hit Rate");
+		DoToolTip("The percentage of sectors that were already\ndecompressed by the time that they were read.");
+		ImGui::TableNextColumn();
+		if (total_reads == 0)
+			ImGui::TextUnformatted("N/A");
+		else
+			ImGui::TextFormatted("{:.1f}% ({}/{})", statistics.hits * 100.0f / total_reads, statistics.hits, total_reads);
+
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted("Decode Time");
+		DoToolTip("The average time taken to decompress a single hunk.");
+		ImGui::TableNextColumn();
+		if (statistics.hunks_decoded == 0)
+			ImGui::TextUnformatted("N/A");
+		else
+			ImGui::TextFormatted("{}us", std::chrono::duration_cast<std::chrono::microseconds>(statistics.total_decode_time).count() / statistics.hunks_decoded);
+
+		ImGui::TableNextColumn();
+		ImGui::TextUnformatted("Cached Hunks");
+		DoToolTip("The number of hunks that are held in RAM.");
+		ImGui::TableNextColumn();
+		ImGui::TextFormatted("{}/{}", statistics.cached_hunks, statistics.maximum_cached_hunks);
+
+		ImGui::EndTable();
+	}
+
+	ImGui::SeparatorText("Software Hashes");
+
+	if (ImGui::BeginTable("Software Hashes", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingFixedFit))
+	{
+		const auto &DoDigests = [&](const char* const label, const std::optional<Hash::Digests> &digests, const char* const tooltip)
+		{
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(label);
+			DoToolTip(tooltip);
+
+			ImGui::PushFont(GetMonospaceFont());
+
+			ImGui::TableNextColumn();
+			if (digests.has_value())
+				ImGui::TextFormatted("{:08X}", digests->crc32);
+			else
+				ImGui::TextUnformatted("N/A");
+
+			ImGui::TableNextColumn();
+			if (digests.has_value())
+				ImGui::TextUnformatted(Hash::ToHexString(digests->sha1));
+			else
+				ImGui::TextUnformatted("N/A");
+
+			ImGui::PopFont();
+		};
+
+		ImGui::TableSetupColumn("");
+		ImGui::TableSetupColumn("CRC32");
+		ImGui::TableSetupColumn("SHA-1");
+		ImGui::TableHeadersRow();
+
+		DoDigests("Cartridge", frontend->emulator->GetCartridgeDigests(), "The hashes of the whole cartridge ROM.");
+		DoDigests("CD", frontend->emulator->GetCDDigests(), "The hashes of the start of the disc's first data track.");
+
+		ImGui::EndTable();
+	}
+
 	ImGui::SeparatorText("Paths");
 
 	if (ImGui::BeginTable("Paths", 2, ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp))
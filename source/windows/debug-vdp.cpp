@@ -13,6 +13,22 @@
 
 #include <SDL3/SDL.h>
 
+// Hardware acceleration is detected at run-time on x86, and at compile-time elsewhere.
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define DEBUG_VDP_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define DEBUG_VDP_TARGET(FEATURES)
+	#else
+		#include <cpuid.h>
+		#define DEBUG_VDP_TARGET(FEATURES) __attribute__((target(FEATURES)))
+	#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+	#define DEBUG_VDP_NEON
+	#include <arm_neon.h>
+#endif
+
 #include "../../libraries/imgui/imgui.h"
 #include "../../common/core/libraries/clowncommon/clowncommon.h"
 #include "../../common/core/source/clownmdemu.h"
@@ -96,6 +112,10 @@ static std::size_t StampMapHeightInStamps()
 static constexpr std::size_t maximum_sprite_diameter_in_tiles = 4;
 static constexpr std::size_t sprite_texture_width = maximum_sprite_diameter_in_tiles * tile_width;
 static constexpr std::size_t sprite_texture_height = maximum_sprite_diameter_in_tiles * tile_height_double_resolution;
+static constexpr std::size_t sprite_atlas_width_in_sprites = 10;
+static constexpr std::size_t sprite_atlas_height_in_sprites = (TOTAL_SPRITES + sprite_atlas_width_in_sprites - 1) / sprite_atlas_width_in_sprites;
+static constexpr std::size_t sprite_atlas_width = sprite_atlas_width_in_sprites * sprite_texture_width;
+static constexpr std::size_t sprite_atlas_height = sprite_atlas_height_in_sprites * sprite_texture_height;
 
 static Sprite GetSprite(const VDP_State &vdp, const cc_u16f sprite_index)
 {
@@ -122,6 +142,20 @@ static PaletteLine GetPaletteLine(const cc_u8f brightness_index, const cc_u8f pa
 	return colours;
 }
 
+static std::uint_least64_t HashBytes(const void* const data, const std::size_t size, std::uint_least64_t hash = 0xCBF29CE484222325)
+{
+	// FNV-1a.
+	const auto bytes = static_cast<const unsigned char*>(data);
+
+	for (std::size_t i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash = (hash * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF;
+	}
+
+	return hash;
+}
+
 static PaletteLines GetPaletteLines(const cc_u8f brightness_index, const bool transparency)
 {
 	PaletteLines palette_lines;
@@ -130,40 +164,193 @@ static PaletteLines GetPaletteLines(const cc_u8f brightness_index, const bool tr
 	return palette_lines;
 }
 
-static void DrawTile(const cc_u16f tile_index, const PaletteLine &palette_line, const cc_u8f tile_width, const cc_u8f tile_height, const ReadTileWord &read_tile_word, SDL::Pixel *pixels, const int pitch)
+// The sources of tile data. These are template parameters rather than callbacks, so that reading a word compiles down to a plain load.
+struct VRAMTileSource
 {
-	constexpr auto PixelsToWords = [](const cc_u16f pixels) constexpr
+	const VDP_State &vdp;
+
+	cc_u16f operator()(const cc_u16f word_index) const
 	{
-		return PixelsToBytes(pixels) / 2;
-	};
+		return VDP_ReadVRAMWord(&vdp, word_index * 2);
+	}
+};
 
-	const cc_u16f tile_size_in_words = PixelsToWords(tile_width * tile_height);
+struct WordRAMTileSource
+{
+	const cc_u16l *words;
 
-	cc_u16f word_index = tile_index * tile_size_in_words;
+	cc_u16f operator()(const cc_u16f word_index) const
+	{
+		return words[word_index];
+	}
+};
+
+#ifdef DEBUG_VDP_X86
+static const bool cpu_has_ssse3 = []()
+{
+#ifdef _MSC_VER
+	std::array<int, 4> registers;
+	__cpuid(std::data(registers), 0);
+
+	if (registers[0] < 1)
+		return false;
+
+	__cpuid(std::data(registers), 1);
+	return (registers[2] & 1 << 9) != 0;
+#else
+	unsigned int eax, ebx, ecx, edx;
+	return __get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0 && (ecx & 1u << 9) != 0;
+#endif
+}();
+#endif
 
-	for (cc_u16f pixel_y_in_tile = 0; pixel_y_in_tile < tile_height; ++pixel_y_in_tile)
+// A row of a tile is eight 4bpp pixels packed into 32 bits, with the leftmost pixel in the highest nibble.
+// Once split apart, the nibbles of the row are in the order 6, 7, 4, 5, 2, 3, 0, 1, so these put them back in order.
+template<bool x_flip>
+static constexpr auto tile_row_nibble_order = x_flip
+	? std::to_array<unsigned char>({1, 0, 3, 2, 5, 4, 7, 6, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80})
+	: std::to_array<unsigned char>({6, 7, 4, 5, 2, 3, 0, 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80});
+
+template<std::size_t tile_height>
+using TileRows = std::array<cc_u32f, tile_height>;
+
+// Each byte of the palette line's colours, split into its own table, so that a byte shuffle can look up a whole row at once.
+using PaletteLineBytes = std::array<std::array<unsigned char, VDP_PALETTE_LINE_LENGTH>, sizeof(SDL::Pixel)>;
+
+// These draw a whole tile per call, so that the palette line is only loaded into registers once per tile.
+#if defined(DEBUG_VDP_X86)
+template<bool x_flip, std::size_t tile_height>
+DEBUG_VDP_TARGET("ssse3") static void DrawTileRowsSSSE3(const TileRows<tile_height> &rows, const PaletteLineBytes &palette_line_bytes, SDL::Pixel *pixels, const int pitch)
+{
+	const __m128i nibble_mask = _mm_set1_epi8(0xF);
+	const __m128i nibble_order = _mm_loadu_si128(reinterpret_cast<const __m128i*>(std::data(tile_row_nibble_order<x_flip>)));
+	const __m128i colour_byte_0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(std::data(palette_line_bytes[0])));
+	const __m128i colour_byte_1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(std::data(palette_line_bytes[1])));
+	const __m128i colour_byte_2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(std::data(palette_line_bytes[2])));
+	const __m128i colour_byte_3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(std::data(palette_line_bytes[3])));
+
+	for (const auto row : rows)
 	{
-		for (cc_u16f i = 0; i < PixelsToWords(tile_width); ++i)
+		const __m128i row_bytes = _mm_cvtsi32_si128(static_cast<int>(row));
+		const __m128i high_nibbles = _mm_and_si128(_mm_srli_epi16(row_bytes, 4), nibble_mask);
+		const __m128i low_nibbles = _mm_and_si128(row_bytes, nibble_mask);
+		const __m128i colour_indices = _mm_shuffle_epi8(_mm_unpacklo_epi8(high_nibbles, low_nibbles), nibble_order);
+
+		// Look up each byte of the colours, and then interleave them back into whole colours.
+		const __m128i low_halves = _mm_unpacklo_epi8(_mm_shuffle_epi8(colour_byte_0, colour_indices), _mm_shuffle_epi8(colour_byte_1, colour_indices));
+		const __m128i high_halves = _mm_unpacklo_epi8(_mm_shuffle_epi8(colour_byte_2, colour_indices), _mm_shuffle_epi8(colour_byte_3, colour_indices));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 0), _mm_unpacklo_epi16(low_halves, high_halves));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 4), _mm_unpackhi_epi16(low_halves, high_halves));
+		pixels += pitch;
+	}
+}
+#elif defined(DEBUG_VDP_NEON)
+template<bool x_flip, std::size_t tile_height>
+static void DrawTileRowsNEON(const TileRows<tile_height> &rows, const PaletteLineBytes &palette_line_bytes, SDL::Pixel *pixels, const int pitch)
+{
+	const uint8x8_t nibble_mask = vdup_n_u8(0xF);
+	const uint8x8_t nibble_order = vld1_u8(std::data(tile_row_nibble_order<x_flip>));
+	const uint8x16_t colour_byte_0 = vld1q_u8(std::data(palette_line_bytes[0]));
+	const uint8x16_t colour_byte_1 = vld1q_u8(std::data(palette_line_bytes[1]));
+	const uint8x16_t colour_byte_2 = vld1q_u8(std::data(palette_line_bytes[2]));
+	const uint8x16_t colour_byte_3 = vld1q_u8(std::data(palette_line_bytes[3]));
+
+	for (const auto row : rows)
+	{
+		const uint8x8_t row_bytes = vreinterpret_u8_u32(vdup_n_u32(static_cast<std::uint32_t>(row)));
+		const uint8x8_t high_nibbles = vshr_n_u8(row_bytes, 4);
+		const uint8x8_t low_nibbles = vand_u8(row_bytes, nibble_mask);
+		const uint8x8_t colour_indices = vtbl1_u8(vzip1_u8(high_nibbles, low_nibbles), nibble_order);
+
+		// Look up each byte of the colours, and then interleave them back into whole colours.
+		uint8x8x4_t colour_bytes;
+		colour_bytes.val[0] = vqtbl1_u8(colour_byte_0, colour_indices);
+		colour_bytes.val[1] = vqtbl1_u8(colour_byte_1, colour_indices);
+		colour_bytes.val[2] = vqtbl1_u8(colour_byte_2, colour_indices);
+		colour_bytes.val[3] = vqtbl1_u8(colour_byte_3, colour_indices);
+		vst4_u8(reinterpret_cast<std::uint8_t*>(pixels), colour_bytes);
+		pixels += pitch;
+	}
+}
+#endif
+
+// Expands tile rows into colours from a particular palette line.
+// Build one of these per palette line rather than per tile, as splitting the palette line up for SIMD is not free.
+class TileRowDecoder
+{
+private:
+	PaletteLine palette_line;
+	PaletteLineBytes palette_line_bytes;
+
+public:
+	TileRowDecoder() = default;
+
+	explicit TileRowDecoder(const PaletteLine &palette_line)
+		: palette_line(palette_line)
+	{
+		// This relies on the colours being little-endian, which they are on every platform that has the SIMD paths.
+		for (std::size_t colour = 0; colour < std::size(palette_line); ++colour)
+			for (std::size_t byte = 0; byte < std::size(palette_line_bytes); ++byte)
+				palette_line_bytes[byte][colour] = static_cast<unsigned char>(palette_line[colour] >> (8 * byte) & 0xFF);
+	}
+
+	template<bool x_flip, std::size_t tile_height>
+	void DrawRows(const TileRows<tile_height> &rows, SDL::Pixel *pixels, const int pitch) const
+	{
+	#ifdef DEBUG_VDP_NEON
+		DrawTileRowsNEON<x_flip>(rows, palette_line_bytes, pixels, pitch);
+	#else
+		#ifdef DEBUG_VDP_X86
+		if (cpu_has_ssse3)
+		{
+			DrawTileRowsSSSE3<x_flip>(rows, palette_line_bytes, pixels, pitch);
+			return;
+		}
+		#endif
+
+		for (const auto row : rows)
 		{
-			const cc_u16f tile_pixels = read_tile_word(word_index);
-			++word_index;
+			for (std::size_t i = 0; i < tile_width; ++i)
+				pixels[x_flip ? tile_width - 1 - i : i] = palette_line[row >> (bits_per_pixel * (tile_width - 1 - i)) & 0xF];
 
-			for (cc_u16f j = 0; j < pixels_per_word; ++j)
-				*pixels++ = palette_line[((tile_pixels << (bits_per_pixel * j)) & 0xF000) >> (bits_per_word - bits_per_pixel)];
+			pixels += pitch;
 		}
+	#endif
+	}
+};
+
+template<std::size_t tile_height, typename TileSource>
+static void DrawTile(const cc_u16f tile_index, const TileRowDecoder &decoder, const TileSource &read_tile_word, SDL::Pixel* const pixels, const int pitch)
+{
+	constexpr cc_u16f tile_size_in_words = PixelsToBytes(tile_width * tile_height) / 2;
+
+	cc_u16f word_index = tile_index * tile_size_in_words;
 
-		pixels += pitch - tile_width;
+	TileRows<tile_height> rows;
+
+	for (auto &row : rows)
+	{
+		row = static_cast<cc_u32f>(read_tile_word(word_index)) << 16 | read_tile_word(word_index + 1);
+		word_index += 2;
 	}
+
+	decoder.DrawRows<false>(rows, pixels, pitch);
 }
 
 static void DrawTileFromVRAM(const cc_u16f tile_index, const PaletteLine &palette_line, SDL::Pixel* const pixels, const int pitch)
 {
 	const auto &vdp = frontend->emulator->GetVDPState();
+	const VRAMTileSource source{vdp};
+	const TileRowDecoder decoder(palette_line);
 
-	DrawTile(tile_index, palette_line, TileWidth(), TileHeight(vdp), [&](const cc_u16f word_index){return VDP_ReadVRAMWord(&vdp, word_index * 2);}, pixels, pitch);
+	if (vdp.double_resolution_enabled)
+		DrawTile<tile_height_double_resolution>(tile_index, decoder, source, pixels, pitch);
+	else
+		DrawTile<tile_height_normal>(tile_index, decoder, source, pixels, pitch);
 }
 
-static void DrawSprite(const cc_u16f initial_tile_index, const PaletteLine &palette_line, const cc_u8f tile_width, const cc_u8f tile_height, const cc_u16f maximum_tile_index, const ReadTileWord &read_tile_word, SDL::Pixel *pixels, const int pitch, const cc_u8f width, const cc_u8f height)
+template<std::size_t tile_height, typename TileSource>
+static void DrawSprite(const cc_u16f initial_tile_index, const TileRowDecoder &decoder, const cc_u16f maximum_tile_index, const TileSource &read_tile_word, SDL::Pixel *pixels, const int pitch, const cc_u8f width, const cc_u8f height)
 {
 	// The loops are this way around as an optimisation.
 	for (cc_u8f iy = 0; iy < height; ++iy)
@@ -172,7 +359,7 @@ static void DrawSprite(const cc_u16f initial_tile_index, const PaletteLine &pale
 
 		for (cc_u8f ix = 0; ix < width; ++ix)
 		{
-			DrawTile(tile_index, palette_line, tile_width, tile_height, read_tile_word, pixels, pitch);
+			DrawTile<tile_height>(tile_index, decoder, read_tile_word, pixels, pitch);
 			pixels += tile_width;
 			tile_index = (tile_index + height) % maximum_tile_index;
 		}
@@ -181,10 +368,24 @@ static void DrawSprite(const cc_u16f initial_tile_index, const PaletteLine &pale
 	}
 }
 
-static auto DrawSprite(const VDP_State &vdp, const unsigned int sprite_index, SDL::Pixel* const pixels, const int pitch)
+static void DrawSprite(const VDP_State &vdp, const unsigned int sprite_index, SDL::Pixel* const pixels, const int pitch)
 {
 	const Sprite &sprite = GetSprite(vdp, sprite_index);
-	return DrawSprite(sprite.tile_metadata.tile_index, GetPaletteLine(0, sprite.tile_metadata.palette_line, true), TileWidth(), TileHeight(vdp), VRAMSizeInTiles(vdp), [&](const cc_u16f word_index){return VDP_ReadVRAMWord(&vdp, word_index * 2);}, pixels, pitch, sprite.cached.width, sprite.cached.height);
+	const TileRowDecoder decoder(GetPaletteLine(0, sprite.tile_metadata.palette_line, true));
+	const VRAMTileSource source{vdp};
+
+	if (vdp.double_resolution_enabled)
+		DrawSprite<tile_height_double_resolution>(sprite.tile_metadata.tile_index, decoder, VRAMSizeInTiles(vdp), source, pixels, pitch, sprite.cached.width, sprite.cached.height);
+	else
+		DrawSprite<tile_height_normal>(sprite.tile_metadata.tile_index, decoder, VRAMSizeInTiles(vdp), source, pixels, pitch, sprite.cached.width, sprite.cached.height);
+}
+
+static void DrawStamp(const cc_u16f stamp_index, const PaletteLine &palette_line, SDL::Pixel* const pixels, const int pitch)
+{
+	const auto tiles_per_stamp = TilesPerStamp();
+	const auto stamp_diameter_in_tiles = StampDiameterInTiles();
+
+	DrawSprite<tile_height_normal>(stamp_index * tiles_per_stamp, TileRowDecoder(palette_line), TotalStamps() * tiles_per_stamp, WordRAMTileSource{frontend->emulator->GetState().mega_cd.word_ram.buffer}, pixels, pitch, stamp_diameter_in_tiles, stamp_diameter_in_tiles);
 }
 
 bool DebugVDP::BrightnessAndPaletteLineSettings::DisplayBrightnessAndPaletteLineSettings()
@@ -232,25 +433,6 @@ void DebugVDP::RegeneratingTexturesBase::RegenerateTexturesIfNeeded(const std::f
 	}
 }
 
-void DebugVDP::RegeneratingTextures::RegenerateTexturesIfNeeded(const std::function<void(unsigned int texture_index, SDL::Pixel *pixels, int pitch)> &callback, const bool force_regenerate)
-{
-	RegeneratingTexturesBase::RegenerateTexturesIfNeeded(
-		[&](const unsigned int texture_index, SDL::Texture &texture)
-		{
-			// Lock texture so that we can write into it.
-			SDL::Pixel *sprite_texture_pixels;
-			int sprite_texture_pitch;
-
-			if (SDL_LockTexture(texture, nullptr, reinterpret_cast<void**>(&sprite_texture_pixels), &sprite_texture_pitch))
-			{
-				callback(texture_index, sprite_texture_pixels, sprite_texture_pitch / sizeof(*sprite_texture_pixels));
-				SDL_UnlockTexture(texture);
-			}
-		},
-		force_regenerate
-	);
-}
-
 void DebugVDP::RegeneratingTexturesHardwareAccelerated::RegenerateTexturesIfNeeded(SDL::Renderer &renderer, const std::function<void(SDL::Renderer &renderer, unsigned int texture_index)> &callback, const bool force_regenerate)
 {
 	RegeneratingTexturesBase::RegenerateTexturesIfNeeded(
@@ -287,12 +469,14 @@ DebugVDP::RegeneratingPieces::RegeneratingPieces(
 	texture_height = texture_height_rounded_up;
 
 	textures.emplace_back(SDL::CreateTexture(renderer, SDL_TEXTUREACCESS_STREAMING, static_cast<int>(texture_width), static_cast<int>(texture_height), SDL_SCALEMODE_PIXELART));
+	pixels.resize(texture_width * texture_height);
 }
 
 void DebugVDP::RegeneratingPieces::RegenerateIfNeeded(
 	const std::size_t piece_width,
 	const std::size_t piece_height,
 	const cc_u8f brightness_index,
+	const void* const piece_data,
 	const RenderPiece &render_piece_callback,
 	const bool force_regenerate)
 {
@@ -300,13 +484,34 @@ void DebugVDP::RegeneratingPieces::RegenerateIfNeeded(
 	const cc_s32f vram_texture_width_in_tiles = texture_width / piece_width;
 	const cc_s32f vram_texture_height_in_tiles = texture_height / piece_height;
 
-	RegenerateTexturesIfNeeded([&]([[maybe_unused]] const unsigned int texture_index, SDL::Pixel* const pixels, const int pitch)
+	RegenerateTexturesIfNeeded([&]([[maybe_unused]] const unsigned int texture_index, SDL::Texture &texture)
 	{
-		// Generate VRAM bitmap.
 		const auto total_pieces = piece_buffer_size_in_pixels / piece_width / piece_height;
+		const auto piece_size_in_bytes = PixelsToBytes(piece_width * piece_height);
 
 		const auto palette_lines = GetPaletteLines(brightness_index, false);
 
+		// Changing the palette or the piece size affects every piece.
+		const bool regenerate_everything = force_regenerate || piece_width != previous_piece_width || piece_height != previous_piece_height || palette_lines != previous_palette_lines;
+
+		previous_piece_width = piece_width;
+		previous_piece_height = piece_height;
+		previous_palette_lines = palette_lines;
+
+		piece_hashes.resize(total_pieces);
+		dirty_pieces.resize(total_pieces);
+		dirty_rows.assign(vram_texture_height_in_tiles, false);
+
+		// Only pieces whose data has changed since the last time need to be decoded again.
+		#pragma omp parallel for
+		for (cc_s32f i = 0; i < static_cast<cc_s32f>(total_pieces); ++i)
+		{
+			const auto hash = HashBytes(static_cast<const unsigned char*>(piece_data) + i * piece_size_in_bytes, piece_size_in_bytes);
+
+			dirty_pieces[i] = regenerate_everything || piece_hashes[i] != hash;
+			piece_hashes[i] = hash;
+		}
+
 		// Use OpenMP to speed this up.
 		// TODO: For tiles, this is exponentially faster, but for stamps
 		// it is only double; is there a cache issue holding this back?
@@ -314,7 +519,7 @@ void DebugVDP::RegeneratingPieces::RegenerateIfNeeded(
 		for (cc_s32f y = 0; y < vram_texture_height_in_tiles; ++y)
 		{
 			cc_u16f piece_index = y * vram_texture_width_in_tiles;
-			auto *pixels_pointer = pixels + y * piece_height * pitch;
+			auto *pixels_pointer = &pixels[y * piece_height * texture_width];
 
 			for (cc_s32f x = 0; x < vram_texture_width_in_tiles; ++x)
 			{
@@ -322,11 +527,30 @@ void DebugVDP::RegeneratingPieces::RegenerateIfNeeded(
 				if (piece_index >= total_pieces * VDP_TOTAL_PALETTE_LINES)
 					break;
 
-				render_piece_callback(piece_index % total_pieces, piece_index / total_pieces, palette_lines, pixels_pointer, pitch);
+				if (dirty_pieces[piece_index % total_pieces])
+				{
+					render_piece_callback(piece_index % total_pieces, piece_index / total_pieces, palette_lines, pixels_pointer, texture_width);
+					dirty_rows[y] = true;
+				}
+
 				++piece_index;
 				pixels_pointer += piece_width;
 			}
 		}
+
+		// Upload only the band of rows that contains changed pieces.
+		const auto first_dirty_row = std::find(std::begin(dirty_rows), std::end(dirty_rows), true);
+
+		if (first_dirty_row == std::end(dirty_rows))
+			return;
+
+		const auto last_dirty_row = std::find(std::rbegin(dirty_rows), std::rend(dirty_rows), true);
+
+		const auto first_y = std::distance(std::begin(dirty_rows), first_dirty_row) * piece_height;
+		const auto end_y = std::distance(last_dirty_row, std::rend(dirty_rows)) * piece_height;
+
+		const SDL_Rect rect = {0, static_cast<int>(first_y), static_cast<int>(texture_width), static_cast<int>(end_y - first_y)};
+		SDL_UpdateTexture(texture, &rect, &pixels[first_y * texture_width], static_cast<int>(texture_width * sizeof(SDL::Pixel)));
 	}, force_regenerate);
 }
 
@@ -341,28 +565,6 @@ SDL_FRect DebugVDP::RegeneratingPieces::GetPieceRect(const std::size_t piece_ind
 	return SDL_FRect(piece_x, piece_y, piece_width, piece_height);
 }
 
-void DebugVDP::RegeneratingPieces::Draw(SDL::Renderer &renderer, const VDP_TileMetadata piece_metadata, const std::size_t piece_width, const std::size_t piece_height, const cc_u16f x, const cc_u16f y, const cc_u8f brightness_index, const bool transparency, const bool swap_coordinates)
-{
-	// TODO: Use the brightness and transparency variables.
-	const auto piece_rect = GetPieceRect(piece_metadata.tile_index, piece_width, piece_height, piece_metadata.palette_line);
-	const auto destination_rect = SDL_FRect(x * piece_width, y * piece_height, piece_width, piece_height);
-
-	int flip = SDL_FLIP_NONE;
-	if (piece_metadata.x_flip)
-		flip ^= SDL_FLIP_HORIZONTAL;
-	if (piece_metadata.y_flip)
-		flip ^= SDL_FLIP_VERTICAL;
-
-	double angle = 0.0;
-	if (swap_coordinates)
-	{
-		angle -= 90.0;
-		flip ^= SDL_FLIP_HORIZONTAL;
-	}
-
-	SDL_RenderTextureRotated(renderer, textures[0], &piece_rect, &destination_rect, angle, nullptr, static_cast<SDL_FlipMode>(flip));
-}
-
 static void ZoomableChild(const char* const label, float &zoom, const float dpi_scale, const std::function<void()> &callback)
 {
 	ImGui::PushID(label);
@@ -388,7 +590,7 @@ void DebugVDP::MapViewer<Derived>::DisplayMap(
 	const std::size_t map_height_in_pieces,
 	const std::size_t piece_width,
 	const std::size_t piece_height,
-	const DrawMapPiece &draw_piece,
+	const DrawMap &draw_map,
 	const MapPieceTooltip &piece_tooltip,
 	const DrawOverlay &draw_overlay,
 	bool force_regenerate)
@@ -403,9 +605,7 @@ void DebugVDP::MapViewer<Derived>::DisplayMap(
 		{
 			RegenerateTexturesIfNeeded(window.GetRenderer(), [&](SDL::Renderer &renderer, [[maybe_unused]] const unsigned int texture_index)
 			{
-				for (cc_u16f y = 0; y < map_height_in_pieces; ++y)
-					for (cc_u16f x = 0; x < map_width_in_pieces; ++x)
-						draw_piece(renderer, x, y);
+				draw_map(renderer);
 
 				if (draw_overlay)
 					draw_overlay(renderer);
@@ -438,6 +638,78 @@ void DebugVDP::MapViewer<Derived>::DisplayMap(
 	);
 }
 
+template<std::size_t tile_height>
+static void DecodePlane(const VDP_State &vdp, const PaletteLines &palette_lines, const cc_u16f plane_address, const std::size_t plane_width, const std::size_t plane_height, SDL::Pixel* const pixels, const int pitch)
+{
+	constexpr auto tile_size_in_bytes = PixelsToBytes(tile_width * tile_height);
+	const auto vram_mask = std::size(vdp.vram) - 1;
+
+	std::array<TileRowDecoder, VDP_TOTAL_PALETTE_LINES> decoders;
+	for (std::size_t i = 0; i < std::size(decoders); ++i)
+		decoders[i] = TileRowDecoder(palette_lines[i]);
+
+	// Each row of tiles is independent, so decode them in parallel straight into the texture,
+	// rather than drawing every tile as a separate textured quad.
+	#pragma omp parallel for
+	for (cc_s32f y = 0; y < static_cast<cc_s32f>(plane_height); ++y)
+	{
+		for (std::size_t x = 0; x < plane_width; ++x)
+		{
+			const auto tile_metadata = VDP_DecomposeTileMetadata(VDP_ReadVRAMWord(&vdp, plane_address + (y * plane_width + x) * 2));
+			const auto &decoder = decoders[tile_metadata.palette_line];
+			const auto tile_address = tile_metadata.tile_index * tile_size_in_bytes;
+
+			auto* const tile_pixels = pixels + y * tile_height * pitch + x * tile_width;
+
+			TileRows<tile_height> rows;
+
+			for (std::size_t pixel_y_in_tile = 0; pixel_y_in_tile < tile_height; ++pixel_y_in_tile)
+			{
+				const auto source_y = tile_metadata.y_flip ? tile_height - 1 - pixel_y_in_tile : pixel_y_in_tile;
+				const auto row_address = tile_address + PixelsToBytes(source_y * tile_width);
+
+				// A row of a tile is exactly two words.
+				rows[pixel_y_in_tile] = static_cast<cc_u32f>(VDP_ReadVRAMWord(&vdp, row_address & vram_mask)) << 16 | VDP_ReadVRAMWord(&vdp, (row_address + 2) & vram_mask);
+			}
+
+			if (tile_metadata.x_flip)
+				decoder.DrawRows<true>(rows, tile_pixels, pitch);
+			else
+				decoder.DrawRows<false>(rows, tile_pixels, pitch);
+		}
+	}
+}
+
+void DebugVDP::PlaneViewer::ComposePlane(SDL::Renderer &renderer, const cc_u16f plane_address, const std::size_t plane_width, const std::size_t plane_height)
+{
+	const auto &vdp = frontend->emulator->GetVDPState();
+
+	const SDL_Rect plane_rect = {0, 0, static_cast<int>(plane_width * TileWidth()), static_cast<int>(plane_height * TileHeight(vdp))};
+	const auto palette_lines = GetPaletteLines(0, false);
+
+	// Static scenes are common, so avoid decoding the plane again if nothing that affects it has changed.
+	const std::array<std::size_t, 4> settings = {plane_address, plane_width, plane_height, TileHeight(vdp)};
+	auto hash = HashBytes(std::data(vdp.vram), sizeof(vdp.vram));
+	hash = HashBytes(&palette_lines, sizeof(palette_lines), hash);
+	hash = HashBytes(&settings, sizeof(settings), hash);
+
+	SDL::Pixel *pixels;
+	int pitch;
+
+	if (plane_hash != hash && SDL_LockTexture(plane_texture, &plane_rect, reinterpret_cast<void**>(&pixels), &pitch))
+	{
+		if (vdp.double_resolution_enabled)
+			DecodePlane<tile_height_double_resolution>(vdp, palette_lines, plane_address, plane_width, plane_height, pixels, pitch / sizeof(*pixels));
+		else
+			DecodePlane<tile_height_normal>(vdp, palette_lines, plane_address, plane_width, plane_height, pixels, pitch / sizeof(*pixels));
+		SDL_UnlockTexture(plane_texture);
+		plane_hash = hash;
+	}
+
+	const SDL_FRect plane_frect = {0.0f, 0.0f, static_cast<float>(plane_rect.w), static_cast<float>(plane_rect.h)};
+	SDL_RenderTexture(renderer, plane_texture, &plane_frect, &plane_frect);
+}
+
 void DebugVDP::PlaneViewer::DisplayInternal(const Plane plane)
 {
 	const auto &vdp = frontend->emulator->GetVDPState();
@@ -449,13 +721,6 @@ void DebugVDP::PlaneViewer::DisplayInternal(const Plane plane)
 	const auto tile_width = TileWidth();
 	const auto tile_height = TileHeight(vdp);
 
-	regenerating_pieces.RegenerateIfNeeded(tile_width, tile_height, 0,
-		[&](const cc_u16f tile_index, const cc_u8f palette_line_index, const PaletteLines &palette_lines, SDL::Pixel* const pixels, const int pitch)
-		{
-			DrawTileFromVRAM(tile_index, palette_lines[palette_line_index], pixels, pitch);
-		}
-	);
-
 	bool force_regenerate = false;
 
 	if (plane != Plane::WINDOW)
@@ -466,12 +731,9 @@ void DebugVDP::PlaneViewer::DisplayInternal(const Plane plane)
 	}
 
 	DisplayMap(plane_width, plane_height, tile_width, tile_height,
-		[&](SDL::Renderer &renderer, const cc_u16f x, const cc_u16f y)
+		[&](SDL::Renderer &renderer)
 		{
-			const cc_u16f plane_index = plane_address + (y * plane_width + x) * 2;
-			const auto tile_metadata = VDP_DecomposeTileMetadata(VDP_ReadVRAMWord(&vdp, plane_index));
-			const cc_u8f brightness = vdp.shadow_highlight_enabled && !tile_metadata.priority;
-			regenerating_pieces.Draw(renderer, tile_metadata, tile_width, tile_height, x, y, brightness, false);
+			ComposePlane(renderer, plane_address, plane_width, plane_height);
 		},
 		[&](const cc_u16f x, const cc_u16f y)
 		{
@@ -497,6 +759,9 @@ void DebugVDP::PlaneViewer::DisplayInternal(const Plane plane)
 							const int normal_screen_width_in_tiles = frontend->emulator->GetCurrentScreenWidth() / VDP_TILE_WIDTH - total_widescreen_tiles * 2;
 							const auto tile_pair_line_size = ImVec2(pixel_size.x * VDP_TILE_WIDTH, pixel_size.y);
 
+							// Submit all of the rectangles at once, as there can be tens of thousands of them.
+							scroll_overlay_rectangles.clear();
+
 							for (unsigned int scanline_index = 0; scanline_index < total_scanlines; ++scanline_index)
 							{
 								const int hscroll = VDP_ReadVRAMWord(&vdp, vdp.hscroll_address + (scanline_index & vdp.hscroll_mask) * 4 + (plane == Plane::A ? 0 : 2)) & (plane_width_in_pixels - 1);
@@ -519,7 +784,7 @@ void DebugVDP::PlaneViewer::DisplayInternal(const Plane plane)
 											rect.y = min.y;
 											rect.w = max.x - min.x;
 											rect.h = max.y - min.y;
-											SDL_RenderFillRect(renderer, &rect);
+											scroll_overlay_rectangles.push_back(rect);
 										}
 									}
 								};
@@ -527,6 +792,8 @@ void DebugVDP::PlaneViewer::DisplayInternal(const Plane plane)
 								DoLine(0);
 								DoLine(plane_width_in_pixels);
 							}
+
+							SDL_RenderFillRects(renderer, std::data(scroll_overlay_rectangles), static_cast<int>(std::size(scroll_overlay_rectangles)));
 						}
 					);
 				}
@@ -548,65 +815,165 @@ static StampMetadata DecomposeStampMetadata(const cc_u16f data)
 	return {.stamp_index = data & 0x7FF, .angle = data >> 13 & 3, .horizontal_flip = (data & 0x8000) != 0};
 }
 
-void DebugVDP::StampMapViewer::DisplayInternal()
+struct StampTransform
 {
-	const auto &state = frontend->emulator->GetState();
+	bool x_flip, y_flip, swap_coordinates;
+};
 
-	const bool options_changed = DisplayBrightnessAndPaletteLineSettings();
+static StampTransform GetStampTransform(const StampMetadata &stamp_metadata)
+{
+	StampTransform transform = {false, false, false};
 
-	ImGui::SeparatorText("Stamp Map");
+	switch (stamp_metadata.angle)
+	{
+		case 0: // 0 degrees
+			break;
+
+		case 1: // 90 degrees
+			transform.x_flip = true;
+			transform.swap_coordinates = true;
+			break;
+
+		case 2: // 180 degrees
+			transform.x_flip = true;
+			transform.y_flip = true;
+			break;
+
+		case 3: // 270 degrees
+			transform.y_flip = true;
+			transform.swap_coordinates = true;
+			break;
+	}
+
+	if (transform.swap_coordinates)
+		transform.y_flip ^= stamp_metadata.horizontal_flip;
+	else
+		transform.x_flip ^= stamp_metadata.horizontal_flip;
+
+	return transform;
+}
+
+void DebugVDP::StampMapViewer::ComposeStampMap(SDL::Renderer &renderer, const bool force_regenerate)
+{
+	const auto &mega_cd = frontend->emulator->GetState().mega_cd;
+	const auto &word_ram = mega_cd.word_ram.buffer;
 
 	const auto stamp_map_width_in_stamps = StampMapWidthInStamps();
 	const auto stamp_map_height_in_stamps = StampMapHeightInStamps();
-	const auto total_stamps = TotalStamps();
-	const auto tiles_per_stamp = TilesPerStamp();
+	const auto stamp_map_diameter_in_pixels = StampMapDiameterInPixels();
 	const auto stamp_diameter_in_tiles = StampDiameterInTiles();
+	const auto stamp_diameter_in_pixels = StampWidthInPixels();
+	const auto tiles_per_stamp = TilesPerStamp();
+	const auto total_stamps = TotalStamps();
+	const auto stamp_size_in_bytes = PixelsToBytes(stamp_diameter_in_pixels * stamp_diameter_in_pixels);
+	const auto palette_line = GetPaletteLines(brightness_option_index, false)[palette_line_option_index];
 
-	regenerating_pieces.RegenerateIfNeeded(StampWidthInPixels(), StampHeightInPixels(), brightness_option_index,
-		[&](const cc_u16f stamp_index, [[maybe_unused]] const cc_u8f palette_line_index, const PaletteLines &palette_lines, SDL::Pixel* const pixels, const int pitch)
-		{
-			DrawSprite(stamp_index * tiles_per_stamp, palette_lines[palette_line_option_index], tile_width, tile_height_normal, total_stamps * tiles_per_stamp, [&](const cc_u16f word_index){return state.mega_cd.word_ram.buffer[word_index];}, pixels, pitch, stamp_diameter_in_tiles, stamp_diameter_in_tiles);
-		}, options_changed
-	);
+	// Changing the layout or the colours affects every stamp.
+	const std::array<std::size_t, 2> settings = {stamp_map_diameter_in_pixels, stamp_diameter_in_pixels};
+	const bool regenerate_everything = force_regenerate || settings != previous_settings || palette_line != previous_palette_line;
 
-	DisplayMap(stamp_map_width_in_stamps, stamp_map_height_in_stamps, StampWidthInPixels(), StampHeightInPixels(),
-		[&](SDL::Renderer &renderer, const cc_u16f x, const cc_u16f y)
+	previous_settings = settings;
+	previous_palette_line = palette_line;
+
+	if (regenerate_everything)
+	{
+		stamp_map_pixels.resize(stamp_map_diameter_in_pixels * stamp_map_diameter_in_pixels);
+		previous_stamp_map.assign(stamp_map_width_in_stamps * stamp_map_height_in_stamps, 0);
+		stamp_hashes.assign(total_stamps, 0);
+	}
+
+	changed_stamps.resize(total_stamps);
+	dirty_rows.assign(stamp_map_height_in_stamps, false);
+
+	// Find which stamps' graphics have changed, so that every cell which uses them can be redrawn.
+	#pragma omp parallel for
+	for (cc_s32f stamp_index = 0; stamp_index < static_cast<cc_s32f>(total_stamps); ++stamp_index)
+	{
+		const auto hash = HashBytes(reinterpret_cast<const unsigned char*>(std::data(word_ram)) + stamp_index * stamp_size_in_bytes, stamp_size_in_bytes);
+
+		changed_stamps[stamp_index] = regenerate_everything || stamp_hashes[stamp_index] != hash;
+		stamp_hashes[stamp_index] = hash;
+	}
+
+	// Each row of cells is independent, so render them in parallel. Rotation and flipping are done by
+	// remapping the coordinates that each pixel is read from, rather than by the renderer.
+	#pragma omp parallel for schedule(dynamic)
+	for (cc_s32f cell_y = 0; cell_y < static_cast<cc_s32f>(stamp_map_height_in_stamps); ++cell_y)
+	{
+		for (std::size_t cell_x = 0; cell_x < stamp_map_width_in_stamps; ++cell_x)
 		{
-			const auto &mega_cd = state.mega_cd;
+			const auto stamp_map_index = cell_y * stamp_map_width_in_stamps + cell_x;
+			const cc_u16f stamp_map_word = word_ram[mega_cd.rotation.stamp_map_address * 2 + stamp_map_index];
+			const auto stamp_metadata = DecomposeStampMetadata(stamp_map_word);
+			const cc_u16f stamp_index = (stamp_metadata.stamp_index * 4) / tiles_per_stamp;
 
-			const cc_u16f stamp_map_index = y * stamp_map_width_in_stamps + x;
-			const auto stamp_metadata = DecomposeStampMetadata(mega_cd.word_ram.buffer[mega_cd.rotation.stamp_map_address * 2 + stamp_map_index]);
-			const cc_u16f stamp_index = (stamp_metadata.stamp_index * 4) / TilesPerStamp();
+			if (!changed_stamps[stamp_index] && previous_stamp_map[stamp_map_index] == stamp_map_word)
+				continue;
 
-			bool x_flip = false, y_flip = false, swap_coordinates = false;
-			switch (stamp_metadata.angle)
-			{
-				case 0: // 0 degrees
-					break;
+			previous_stamp_map[stamp_map_index] = stamp_map_word;
+			dirty_rows[cell_y] = true;
 
-				case 1: // 90 degrees
-					x_flip = true;
-					swap_coordinates = true;
-					break;
+			const auto transform = GetStampTransform(stamp_metadata);
+			const auto first_tile_index = stamp_index * tiles_per_stamp;
 
-				case 2: // 180 degrees
-					x_flip = true;
-					y_flip = true;
-					break;
+			auto *pixels = &stamp_map_pixels[cell_y * stamp_diameter_in_pixels * stamp_map_diameter_in_pixels + cell_x * stamp_diameter_in_pixels];
 
-				case 3: // 270 degrees
-					y_flip = true;
-					swap_coordinates = true;
-					break;
+			for (std::size_t destination_y = 0; destination_y < stamp_diameter_in_pixels; ++destination_y)
+			{
+				for (std::size_t destination_x = 0; destination_x < stamp_diameter_in_pixels; ++destination_x)
+				{
+					// This matches rotating the stamp by -90 degrees and then flipping it horizontally, which is a transpose.
+					const auto u = transform.swap_coordinates ? destination_y : destination_x;
+					const auto v = transform.swap_coordinates ? destination_x : destination_y;
+					const auto source_x = transform.x_flip ? stamp_diameter_in_pixels - 1 - u : u;
+					const auto source_y = transform.y_flip ? stamp_diameter_in_pixels - 1 - v : v;
+
+					// The tiles of a stamp are arranged in columns.
+					const auto tile_index = first_tile_index + source_x / tile_width * stamp_diameter_in_tiles + source_y / tile_height_normal;
+					const auto word_index = tile_index * PixelsToBytes(tile_width * tile_height_normal) / 2 + source_y % tile_height_normal * (tile_width / pixels_per_word) + source_x % tile_width / pixels_per_word;
+					const auto colour_index = word_ram[word_index] >> (bits_per_word - bits_per_pixel * (source_x % pixels_per_word + 1)) & 0xF;
+
+					pixels[destination_x] = palette_line[colour_index];
+				}
+
+				pixels += stamp_map_diameter_in_pixels;
 			}
+		}
+	}
 
-			if (swap_coordinates)
-				y_flip ^= stamp_metadata.horizontal_flip;
-			else
-				x_flip ^= stamp_metadata.horizontal_flip;
+	// Upload only the band of rows that contains changed cells.
+	const auto first_dirty_row = std::find(std::begin(dirty_rows), std::end(dirty_rows), true);
+
+	if (first_dirty_row != std::end(dirty_rows))
+	{
+		const auto last_dirty_row = std::find(std::rbegin(dirty_rows), std::rend(dirty_rows), true);
+
+		const auto first_y = std::distance(std::begin(dirty_rows), first_dirty_row) * stamp_diameter_in_pixels;
+		const auto end_y = std::distance(last_dirty_row, std::rend(dirty_rows)) * stamp_diameter_in_pixels;
+
+		const SDL_Rect rect = {0, static_cast<int>(first_y), static_cast<int>(stamp_map_diameter_in_pixels), static_cast<int>(end_y - first_y)};
+		SDL_UpdateTexture(stamp_map_texture, &rect, &stamp_map_pixels[first_y * stamp_map_diameter_in_pixels], static_cast<int>(stamp_map_diameter_in_pixels * sizeof(SDL::Pixel)));
+	}
+
+	const SDL_FRect stamp_map_rect = {0.0f, 0.0f, static_cast<float>(stamp_map_diameter_in_pixels), static_cast<float>(stamp_map_diameter_in_pixels)};
+	SDL_RenderTexture(renderer, stamp_map_texture, &stamp_map_rect, &stamp_map_rect);
+}
+
+void DebugVDP::StampMapViewer::DisplayInternal()
+{
+	const auto &state = frontend->emulator->GetState();
+
+	const bool options_changed = DisplayBrightnessAndPaletteLineSettings();
+
+	ImGui::SeparatorText("Stamp Map");
+
+	const auto stamp_map_width_in_stamps = StampMapWidthInStamps();
+	const auto stamp_map_height_in_stamps = StampMapHeightInStamps();
 
-			const VDP_TileMetadata tile_metadata = {.tile_index = stamp_index, .palette_line = 0, .x_flip = x_flip, .y_flip = y_flip, .priority = cc_false};
-			regenerating_pieces.Draw(renderer, tile_metadata, StampWidthInPixels(), StampHeightInPixels(), x, y, brightness_option_index, false, swap_coordinates);
+	DisplayMap(stamp_map_width_in_stamps, stamp_map_height_in_stamps, StampWidthInPixels(), StampHeightInPixels(),
+		[&](SDL::Renderer &renderer)
+		{
+			ComposeStampMap(renderer, options_changed);
 		},
 		[&](const cc_u16f x, const cc_u16f y)
 		{
@@ -623,24 +990,64 @@ void DebugVDP::StampMapViewer::DisplayInternal()
 }
 
 DebugVDP::SpriteCommon::SpriteCommon(SDL::Renderer &renderer)
+	: atlas_pixels(sprite_atlas_width * sprite_atlas_height)
 {
-	textures.reserve(TOTAL_SPRITES);
-
-	for (cc_u8f i = 0; i < TOTAL_SPRITES; ++i)
-		textures.emplace_back(SDL::CreateTextureWithBlending(renderer, SDL_TEXTUREACCESS_STREAMING, sprite_texture_width, sprite_texture_height, SDL_SCALEMODE_PIXELART));
+	textures.emplace_back(SDL::CreateTextureWithBlending(renderer, SDL_TEXTUREACCESS_STREAMING, sprite_atlas_width, sprite_atlas_height, SDL_SCALEMODE_PIXELART));
 }
 
 void DebugVDP::SpriteCommon::DisplaySpriteCommon()
 {
 	const VDP_State &vdp = frontend->emulator->GetVDPState();
 	RegenerateTexturesIfNeeded(
-		[&](const unsigned int texture_index, SDL::Pixel* const pixels, const int pitch)
+		[&]([[maybe_unused]] const unsigned int texture_index, SDL::Texture &texture)
 		{
-			DrawSprite(vdp, texture_index, pixels, pitch);
+			const auto tile_size_in_bytes = TileSizeInBytes(vdp);
+			const auto vram_size_in_tiles = VRAMSizeInTiles(vdp);
+			const auto vram_bytes = reinterpret_cast<const unsigned char*>(std::data(vdp.vram));
+
+			std::array<bool, TOTAL_SPRITES> sprite_changed;
+
+			#pragma omp parallel for schedule(dynamic)
+			for (cc_s32f sprite_index = 0; sprite_index < TOTAL_SPRITES; ++sprite_index)
+			{
+				const Sprite sprite = GetSprite(vdp, sprite_index);
+				const auto palette_line = GetPaletteLine(0, sprite.tile_metadata.palette_line, true);
+
+				// A sprite only needs decoding again if its size, colours, or tiles have changed.
+				// Flipping is done when the sprite is drawn, so it does not matter here.
+				const std::array<std::size_t, 4> attributes = {sprite.tile_metadata.tile_index, sprite.cached.width, sprite.cached.height, tile_size_in_bytes};
+				auto hash = HashBytes(&attributes, sizeof(attributes));
+				hash = HashBytes(&palette_line, sizeof(palette_line), hash);
+
+				for (cc_u16f i = 0; i < sprite.cached.width * sprite.cached.height; ++i)
+					hash = HashBytes(&vram_bytes[(sprite.tile_metadata.tile_index + i) % vram_size_in_tiles * tile_size_in_bytes], tile_size_in_bytes, hash);
+
+				sprite_changed[sprite_index] = sprite_hashes[sprite_index] != hash;
+				sprite_hashes[sprite_index] = hash;
+
+				if (sprite_changed[sprite_index])
+				{
+					const auto rect = GetSpriteAtlasRect(sprite_index, 0, 0);
+					DrawSprite(vdp, sprite_index, &atlas_pixels[rect.y * sprite_atlas_width + rect.x], sprite_atlas_width);
+				}
+			}
+
+			if (std::find(std::begin(sprite_changed), std::end(sprite_changed), true) != std::end(sprite_changed))
+				SDL_UpdateTexture(texture, nullptr, std::data(atlas_pixels), sprite_atlas_width * sizeof(SDL::Pixel));
 		}
 	);
 }
 
+SDL_FRect DebugVDP::SpriteCommon::GetSpriteAtlasRect(const cc_u8f sprite_index, const float width, const float height)
+{
+	return {
+		static_cast<float>(sprite_index % sprite_atlas_width_in_sprites * sprite_texture_width),
+		static_cast<float>(sprite_index / sprite_atlas_width_in_sprites * sprite_texture_height),
+		width,
+		height
+	};
+}
+
 void DebugVDP::SpriteViewer::DisplayInternal()
 {
 	auto &window = GetWindow();
@@ -687,16 +1094,41 @@ void DebugVDP::SpriteViewer::DisplayInternal()
 									break;
 							}
 
-							// Draw sprites to the plane texture.
+							// Draw sprites to the plane texture, all in a single batch.
+							sprite_vertices.clear();
+							sprite_indices.clear();
+
 							for (auto it = sprite_vector.crbegin(); it != sprite_vector.crend(); ++it)
 							{
 								const cc_u8f sprite_index = *it;
 								const Sprite sprite = GetSprite(vdp, sprite_index);
 
-								const SDL_FRect src_rect = {0, 0, static_cast<float>(sprite.cached.width * tile_width), static_cast<float>(sprite.cached.height * tile_height)};
-								const SDL_FRect dst_rect = {static_cast<float>(sprite.x), static_cast<float>(sprite.cached.y), static_cast<float>(sprite.cached.width * tile_width), static_cast<float>(sprite.cached.height * tile_height)};
-								SDL_RenderTextureRotated(renderer, textures[sprite_index], &src_rect, &dst_rect, 0.0, nullptr, static_cast<SDL_FlipMode>((sprite.tile_metadata.x_flip ? SDL_FLIP_HORIZONTAL : 0) | (sprite.tile_metadata.y_flip ? SDL_FLIP_VERTICAL : 0)));
+								const float width = sprite.cached.width * tile_width;
+								const float height = sprite.cached.height * tile_height;
+								const auto src_rect = GetSpriteAtlasRect(sprite_index, width, height);
+								const SDL_FRect dst_rect = {static_cast<float>(sprite.x), static_cast<float>(sprite.cached.y), width, height};
+
+								float u0 = src_rect.x / sprite_atlas_width, u1 = (src_rect.x + src_rect.w) / sprite_atlas_width;
+								float v0 = src_rect.y / sprite_atlas_height, v1 = (src_rect.y + src_rect.h) / sprite_atlas_height;
+
+								if (sprite.tile_metadata.x_flip)
+									std::swap(u0, u1);
+								if (sprite.tile_metadata.y_flip)
+									std::swap(v0, v1);
+
+								const int first_vertex = static_cast<int>(std::size(sprite_vertices));
+								const SDL_FColor colour = {1.0f, 1.0f, 1.0f, 1.0f};
+
+								sprite_vertices.push_back({{dst_rect.x, dst_rect.y}, colour, {u0, v0}});
+								sprite_vertices.push_back({{dst_rect.x + dst_rect.w, dst_rect.y}, colour, {u1, v0}});
+								sprite_vertices.push_back({{dst_rect.x + dst_rect.w, dst_rect.y + dst_rect.h}, colour, {u1, v1}});
+								sprite_vertices.push_back({{dst_rect.x, dst_rect.y + dst_rect.h}, colour, {u0, v1}});
+
+								for (const int index : {0, 1, 2, 0, 2, 3})
+									sprite_indices.push_back(first_vertex + index);
 							}
+
+							SDL_RenderGeometry(renderer, textures[0], std::data(sprite_vertices), static_cast<int>(std::size(sprite_vertices)), std::data(sprite_indices), static_cast<int>(std::size(sprite_indices)));
 						}
 					);
 				}
@@ -768,15 +1200,18 @@ void DebugVDP::SpriteList::DisplayInternal()
 			ImGui::PushID(index);
 			if (ImGui::BeginChild("Sprite", image_destination_space))
 			{
-				ImVec2 uv0 = {0, 0};
-				ImVec2 uv1 = image_size / image_internal_size;
+				const auto atlas_size = ImVec2(sprite_atlas_width, sprite_atlas_height);
+				const auto atlas_rect = GetSpriteAtlasRect(index, image_size.x, image_size.y);
+
+				ImVec2 uv0 = ImVec2(atlas_rect.x, atlas_rect.y) / atlas_size;
+				ImVec2 uv1 = (ImVec2(atlas_rect.x, atlas_rect.y) + image_size) / atlas_size;
 				if (sprite.tile_metadata.x_flip)
 					std::swap(uv0.x, uv1.x);
 				if (sprite.tile_metadata.y_flip)
 					std::swap(uv0.y, uv1.y);
 
 				ImGui::SetCursorPos(image_destination_offset);
-				ImGui::ImageCopyable(GetWindow(), ImTextureRef(textures[index]), image_destination_size, uv0, uv1);
+				ImGui::ImageCopyable(GetWindow(), ImTextureRef(textures[0]), image_destination_size, uv0, uv1);
 			}
 			ImGui::EndChild();
 			ImGui::PopID();
@@ -831,6 +1266,7 @@ void DebugVDP::GridViewer<Derived, default_line_length>::DisplayGrid(
 	const std::size_t piece_width,
 	const std::size_t piece_height,
 	const std::size_t total_pieces,
+	const void* const piece_data,
 	const RenderPiece &render_piece_callback,
 	const char* const label_singular,
 	const char* const label_plural)
@@ -852,7 +1288,7 @@ void DebugVDP::GridViewer<Derived, default_line_length>::DisplayGrid(
 
 	ImGui::SeparatorText(label_plural);
 
-	regenerating_pieces.RegenerateIfNeeded(piece_width, piece_height, brightness_option_index, render_piece_callback, options_changed);
+	regenerating_pieces.RegenerateIfNeeded(piece_width, piece_height, brightness_option_index, piece_data, render_piece_callback, options_changed);
 
 	// Actually display the VRAM now.
 	ImGui::BeginChild("VRAM contents");
@@ -951,7 +1387,7 @@ void DebugVDP::VRAMViewer::DisplayInternal()
 	const cc_u16f piece_height = TileHeight(vdp);
 	const std::size_t total_pieces = VRAMSizeInTiles(vdp);
 
-	DisplayGrid(piece_width, piece_height, total_pieces,
+	DisplayGrid(piece_width, piece_height, total_pieces, std::data(vdp.vram),
 		[&](const cc_u16f piece_index, [[maybe_unused]] const cc_u8f palette_line_index, const PaletteLines &palette_lines, SDL::Pixel* const pixels, const int pitch)
 		{
 			DrawTileFromVRAM(piece_index, palette_lines[palette_line_option_index], pixels, pitch);
@@ -966,13 +1402,12 @@ void DebugVDP::StampViewer::DisplayInternal()
 	const auto piece_diameter_in_tiles = StampDiameterInTiles();
 	const auto piece_width_in_pixels = piece_diameter_in_tiles * tile_width;
 	const auto piece_height_in_pixels = piece_diameter_in_tiles * tile_height_normal;
-	const auto tiles_per_stamp = TilesPerStamp();
 	const auto total_pieces = TotalStamps();
 
-	DisplayGrid(piece_width_in_pixels, piece_height_in_pixels, total_pieces,
+	DisplayGrid(piece_width_in_pixels, piece_height_in_pixels, total_pieces, std::data(state.mega_cd.word_ram.buffer),
 		[&](const cc_u16f piece_index, [[maybe_unused]] const cc_u8f palette_line_index, const PaletteLines palette_lines, SDL::Pixel* const pixels, const int pitch)
 		{
-			DrawSprite(piece_index * tiles_per_stamp, palette_lines[palette_line_option_index], tile_width, tile_height_normal, total_pieces * tiles_per_stamp, [&](const cc_u16f word_index){return state.mega_cd.word_ram.buffer[word_index];}, pixels, pitch, piece_diameter_in_tiles, piece_diameter_in_tiles);
+			DrawStamp(piece_index, palette_lines[palette_line_option_index], pixels, pitch);
 		}
 	, "Stamp", "Stamps");
 }
@@ -3,7 +3,10 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <optional>
+#include <vector>
 
 #include "../sdl-wrapper-extra.h"
 
@@ -35,8 +38,7 @@ namespace DebugVDP
 
 	constexpr cc_u8f TOTAL_SPRITES = 80;
 
-	using ReadTileWord = std::function<cc_u16f(cc_u16f word_index)>;
-	using DrawMapPiece = std::function<void(SDL::Renderer &renderer, cc_u16f x, cc_u16f y)>;
+	using DrawMap = std::function<void(SDL::Renderer &renderer)>;
 	using MapPieceTooltip = std::function<void(cc_u16f x, cc_u16f y)>;
 	using PaletteLine = std::array<SDL::Pixel, VDP_PALETTE_LINE_LENGTH>;
 	using PaletteLines = std::array<PaletteLine, VDP_TOTAL_PALETTE_LINES>;
@@ -69,13 +71,6 @@ namespace DebugVDP
 		void RegenerateTexturesIfNeeded(const std::function<void(unsigned int texture_index, SDL::Texture &texture)> &callback, bool force_regenerate = false);
 	};
 
-	struct RegeneratingTextures : private RegeneratingTexturesBase
-	{
-		using RegeneratingTexturesBase::textures;
-
-		void RegenerateTexturesIfNeeded(const std::function<void(unsigned int texture_index, SDL::Pixel *pixels, int pitch)> &callback, bool force_regenerate = false);
-	};
-
 	struct RegeneratingTexturesHardwareAccelerated : private RegeneratingTexturesBase
 	{
 		using RegeneratingTexturesBase::textures;
@@ -84,7 +79,7 @@ namespace DebugVDP
 	};
 
 
-	struct RegeneratingPieces : public RegeneratingTextures
+	struct RegeneratingPieces : private RegeneratingTexturesBase
 	{
 	protected:
 		const std::size_t piece_buffer_size_in_pixels;
@@ -93,7 +88,19 @@ namespace DebugVDP
 		std::size_t texture_width = 0;
 		std::size_t texture_height = 0;
 
+		// Streaming textures cannot be read back, so the decoded pieces are kept here,
+		// allowing only the pieces that have changed to be decoded and uploaded again.
+		std::vector<SDL::Pixel> pixels;
+		std::vector<std::uint_least64_t> piece_hashes;
+		std::vector<unsigned char> dirty_pieces;
+		std::vector<unsigned char> dirty_rows;
+		std::size_t previous_piece_width = 0;
+		std::size_t previous_piece_height = 0;
+		std::optional<PaletteLines> previous_palette_lines;
+
 	public:
+		using RegeneratingTexturesBase::textures;
+
 		RegeneratingPieces(
 			SDL::Renderer &renderer,
 			std::size_t maximum_piece_width,
@@ -101,10 +108,12 @@ namespace DebugVDP
 			std::size_t piece_buffer_size_in_pixels,
 			bool multiple_palette_lines);
 
+		// 'piece_data' is the raw 4bpp data that the pieces are decoded from, and is used to detect which pieces have changed.
 		void RegenerateIfNeeded(
 			std::size_t piece_width,
 			std::size_t piece_height,
 			cc_u8f brightness_index,
+			const void *piece_data,
 			const RenderPiece &render_piece_callback,
 			bool force_regenerate = false);
 
@@ -119,15 +128,19 @@ namespace DebugVDP
 		}
 
 		SDL_FRect GetPieceRect(const std::size_t piece_index, std::size_t piece_width, std::size_t piece_height, cc_u8f palette_line_index) const;
-
-		void Draw(SDL::Renderer &renderer, VDP_TileMetadata piece_metadata, std::size_t piece_width, std::size_t piece_height, cc_u16f x, cc_u16f y, cc_u8f brightness_index, bool transparency, bool swap_coordinates = false);
 	};
 
-	struct SpriteCommon : protected RegeneratingTextures
+	struct SpriteCommon : protected RegeneratingTexturesBase
 	{
 	protected:
+		// Every sprite is decoded into its own slot of a single atlas texture, which is uploaded in one go.
+		// Like with RegeneratingPieces, a copy is kept on the CPU so that only changed sprites need decoding.
+		std::vector<SDL::Pixel> atlas_pixels;
+		std::array<std::optional<std::uint_least64_t>, TOTAL_SPRITES> sprite_hashes;
+
 		// TODO: Make this some kind of internal layer over DisplayInternal?
 		void DisplaySpriteCommon();
+		static SDL_FRect GetSpriteAtlasRect(cc_u8f sprite_index, float width, float height);
 
 		SpriteCommon(SDL::Renderer &renderer);
 	};
@@ -144,6 +157,8 @@ namespace DebugVDP
 
 		float scale = 2.0f;
 		SDL::Texture texture = SDL::CreateTexture(Base::GetWindow().GetRenderer(), SDL_TEXTUREACCESS_TARGET, plane_texture_width, plane_texture_height, SDL_SCALEMODE_PIXELART);
+		std::vector<SDL_Vertex> sprite_vertices;
+		std::vector<int> sprite_indices;
 
 		void DisplayInternal();
 
@@ -191,7 +206,7 @@ namespace DebugVDP
 			std::size_t map_height_in_pieces,
 			std::size_t piece_width,
 			std::size_t piece_height,
-			const DrawMapPiece &draw_piece,
+			const DrawMap &draw_map,
 			const MapPieceTooltip &piece_tooltip,
 			const DrawOverlay &draw_overlay = {},
 			bool force_regenerate = false);
@@ -216,17 +231,24 @@ namespace DebugVDP
 	private:
 		using Base = MapViewer<PlaneViewer>;
 
+		static constexpr std::size_t maximum_plane_width_in_tiles = 128;
+		static constexpr std::size_t maximum_plane_height_in_tiles = 64;
+
 		float scale = 2.0f;
 		bool scroll_overlay_enabled = false;
 		std::array<float, 4> scroll_overlay_colour = {1.0f, 0.0f, 0.0f, 0.5f};
-		RegeneratingPieces regenerating_pieces = {Base::GetWindow().GetRenderer(), tile_width, tile_height_double_resolution, sizeof(VDP_State::vram) * pixels_per_byte, true};
+		// The plane is composited on the CPU into this, and then copied into the map texture in one go.
+		SDL::Texture plane_texture = SDL::CreateTexture(Base::GetWindow().GetRenderer(), SDL_TEXTUREACCESS_STREAMING, maximum_plane_width_in_tiles * tile_width, maximum_plane_height_in_tiles * tile_height_double_resolution, SDL_SCALEMODE_PIXELART);
+		std::vector<SDL_FRect> scroll_overlay_rectangles;
+		std::optional<std::uint_least64_t> plane_hash;
 
+		void ComposePlane(SDL::Renderer &renderer, cc_u16f plane_address, std::size_t plane_width, std::size_t plane_height);
 		void DisplayInternal(Plane plane);
 
 	public:
 		template<typename... Args>
 		PlaneViewer(Args &&...args)
-			: Base(128 * tile_width, 64 * tile_height_double_resolution, std::forward<Args>(args)...)
+			: Base(maximum_plane_width_in_tiles * tile_width, maximum_plane_height_in_tiles * tile_height_double_resolution, std::forward<Args>(args)...)
 		{}
 
 		friend Base;
@@ -239,8 +261,17 @@ namespace DebugVDP
 		using Base = MapViewer<StampMapViewer>;
 
 		float scale = 1.0f;
-		RegeneratingPieces regenerating_pieces = {Base::GetWindow().GetRenderer(), maximum_stamp_width_in_pixels, maximum_stamp_height_in_pixels, maximum_stamp_map_size_in_pixels, false};
-
+		// The stamp map is rendered on the CPU into this, and then copied into the map texture in one go.
+		SDL::Texture stamp_map_texture = SDL::CreateTexture(Base::GetWindow().GetRenderer(), SDL_TEXTUREACCESS_STREAMING, maximum_stamp_map_diameter_in_pixels, maximum_stamp_map_diameter_in_pixels, SDL_SCALEMODE_PIXELART);
+		std::vector<SDL::Pixel> stamp_map_pixels;
+		std::vector<cc_u16l> previous_stamp_map;
+		std::vector<std::uint_least64_t> stamp_hashes;
+		std::vector<unsigned char> changed_stamps;
+		std::vector<unsigned char> dirty_rows;
+		std::array<std::size_t, 2> previous_settings = {};
+		std::optional<PaletteLine> previous_palette_line;
+
+		void ComposeStampMap(SDL::Renderer &renderer, bool force_regenerate);
 		void DisplayInternal();
 
 	public:
@@ -266,6 +297,7 @@ namespace DebugVDP
 			std::size_t piece_width,
 			std::size_t piece_height,
 			std::size_t total_pieces,
+			const void *piece_data,
 			const RenderPiece &render_piece_callback,
 			const char *label_singular,
 			const char *label_plural);
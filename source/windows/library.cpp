@@ -0,0 +1,172 @@
+#include "library.h"
+
+#include <algorithm>
+#include <cctype>
+#include <optional>
+
+#include <fmt/format.h>
+
+#include "../../libraries/imgui/misc/cpp/imgui_stdlib.h"
+
+#include "../file-utilities.h"
+
+static std::string ToLower(std::string string)
+{
+	std::transform(std::begin(string), std::end(string), std::begin(string), [](const unsigned char character) { return std::tolower(character); });
+	return string;
+}
+
+void LibraryWindow::UpdateFilteredEntries(const std::vector<Library::Entry> &entries)
+{
+	if (filtered_with == filter && filtered_entries_source == std::data(entries) && filtered_entries_source_size == std::size(entries))
+		return;
+
+	filtered_with = filter;
+	filtered_entries_source = std::data(entries);
+	filtered_entries_source_size = std::size(entries);
+
+	filtered_entries.clear();
+
+	const auto lowercase_filter = ToLower(filter);
+
+	for (std::size_t i = 0; i < std::size(entries); ++i)
+	{
+		const auto &entry = entries[i];
+
+		const auto &Matches = [&](const std::string &string)
+		{
+			return ToLower(string).find(lowercase_filter) != std::string::npos;
+		};
+
+		if (Matches(entry.GetName()) || Matches(entry.domestic_name))
+			filtered_entries.push_back(i);
+	}
+}
+
+void LibraryWindow::DisplayInternal(Library &library, const std::function<void(const Library::Entry &entry)> &load_callback)
+{
+	// Pick up any files which have been added or changed since the library was last opened.
+	if (!scan_started)
+	{
+		scan_started = true;
+		library.StartScan();
+	}
+
+	if (ImGui::CollapsingHeader("Directories", library.directories.empty() ? ImGuiTreeNodeFlags_DefaultOpen : ImGuiTreeNodeFlags_None))
+	{
+		std::optional<std::size_t> directory_to_remove;
+
+		for (std::size_t i = 0; i < std::size(library.directories); ++i)
+		{
+			ImGui::PushID(i);
+
+			if (ImGui::Button("Remove"))
+				directory_to_remove = i;
+
+			ImGui::SameLine();
+			ImGui::TextUnformatted(library.directories[i]);
+
+			ImGui::PopID();
+		}
+
+		if (directory_to_remove.has_value())
+		{
+			library.directories.erase(std::begin(library.directories) + *directory_to_remove);
+			library.StartScan();
+		}
+
+		const bool entered = ImGui::InputTextWithHint("##Directory", "Path to a directory of software", &new_directory, ImGuiInputTextFlags_EnterReturnsTrue);
+		ImGui::SameLine();
+
+		if ((ImGui::Button("Add") || entered) && !new_directory.empty())
+		{
+			library.directories.push_back(FileUtilities::U8Path(new_directory));
+			new_directory.clear();
+			library.StartScan();
+		}
+	}
+
+	ImGui::BeginDisabled(library.IsScanning());
+	if (ImGui::Button("Rescan"))
+		library.StartScan();
+	ImGui::EndDisabled();
+
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(-FLT_MIN);
+	ImGui::InputTextWithHint("##Filter", "Filter", &filter);
+
+	if (library.IsScanning())
+	{
+		const auto files_found = library.GetFilesFound();
+		const auto files_scanned = library.GetFilesScanned();
+
+		// Until the directories have been walked, the total is unknown, so show an indeterminate bar.
+		const float fraction = files_found == 0 ? -1.0f * static_cast<float>(ImGui::GetTime()) : static_cast<float>(files_scanned) / files_found;
+		ImGui::ProgressBar(fraction, ImVec2(-FLT_MIN, 0), fmt::format("Scanning... {}/{}", files_scanned, files_found).c_str());
+	}
+	else if (const auto scan_duration = library.GetLastScanDuration(); scan_duration.has_value())
+	{
+		ImGui::TextFormatted("Scanned {} files in {:.2f} seconds.", library.GetFilesScanned(), *scan_duration);
+	}
+
+	const auto &entries = library.GetEntries();
+	UpdateFilteredEntries(entries);
+
+	if (ImGui::BeginTable("Software", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY))
+	{
+		const auto dpi_scale = GetWindow().GetDPIScale();
+
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Name");
+		ImGui::TableSetupColumn("Type", ImGuiTableColumnFlags_WidthFixed, 70 * dpi_scale);
+		ImGui::TableSetupColumn("Regions", ImGuiTableColumnFlags_WidthFixed, 60 * dpi_scale);
+		ImGui::TableSetupColumn("CRC32", ImGuiTableColumnFlags_WidthFixed, 70 * dpi_scale);
+		ImGui::TableHeadersRow();
+
+		ImGuiListClipper clipper;
+		clipper.Begin(std::size(filtered_entries));
+		while (clipper.Step())
+		{
+			for (auto i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+			{
+				const auto &entry = entries[filtered_entries[i]];
+
+				ImGui::PushID(i);
+				ImGui::TableNextRow();
+
+				ImGui::TableNextColumn();
+				if (ImGui::Selectable(entry.GetName().c_str(), false, ImGuiSelectableFlags_SpanAllColumns | ImGuiSelectableFlags_AllowDoubleClick) && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
+					load_callback(entry);
+
+				if (ImGui::BeginItemTooltip())
+				{
+					ImGui::TextUnformatted(entry.path);
+
+					if (!entry.domestic_name.empty())
+						ImGui::TextFormatted("Domestic Name: {}", entry.domestic_name);
+
+					ImGui::TextFormatted("SHA-1: {}{}", Hash::ToHexString(entry.digests.sha1), entry.is_cd_file ? " (first megabyte)" : "");
+					ImGui::EndTooltip();
+				}
+
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(entry.is_cd_file ? "CD" : "Cartridge");
+
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(entry.regions.c_str());
+
+				ImGui::TableNextColumn();
+				ImGui::PushFont(GetMonospaceFont());
+				ImGui::TextFormatted("{:08X}", entry.digests.crc32);
+				ImGui::PopFont();
+
+				ImGui::PopID();
+			}
+		}
+
+		ImGui::EndTable();
+	}
+
+	if (entries.empty() && !library.IsScanning())
+		ImGui::TextDisabled("No software found. Add a directory above, then rescan.");
+}
@@ -0,0 +1,38 @@
+#ifndef LIBRARY_WINDOW_H
+#define LIBRARY_WINDOW_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../library.h"
+#include "common/window-popup.h"
+
+class LibraryWindow : public WindowPopup<LibraryWindow>
+{
+private:
+	using Base = WindowPopup<LibraryWindow>;
+
+	static constexpr Uint32 window_flags = 0;
+
+	std::string filter;
+	std::string new_directory;
+	bool scan_started = false;
+
+	// Filtering thousands of entries every frame would be wasteful, so it is only redone when something changes.
+	std::vector<std::size_t> filtered_entries;
+	std::string filtered_with;
+	const Library::Entry *filtered_entries_source = nullptr;
+	std::size_t filtered_entries_source_size = 0;
+
+	void UpdateFilteredEntries(const std::vector<Library::Entry> &entries);
+	void DisplayInternal(Library &library, const std::function<void(const Library::Entry &entry)> &load_callback);
+
+public:
+	using Base::WindowPopup;
+
+	friend Base;
+};
+
+#endif /* LIBRARY_WINDOW_H */